@@ -0,0 +1,388 @@
+#ifndef ASYNCLOGGER_HPP
+#define ASYNCLOGGER_HPP
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <cerrno>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "Interpolate.hpp"
+
+namespace cs540 {
+
+/* Strings are logged by copy and given back as string_view, everything else by value */
+template <typename T>
+using LoggedType = std::conditional_t<std::is_convertible_v<const T&, std::string_view>, std::string_view, std::decay_t<T>>;
+
+/* Bytes taken by one argument in a record */
+template <typename T>
+std::size_t loggedSize(const T& t) {
+	if constexpr(std::is_same_v<LoggedType<T>, std::string_view>) {
+		return sizeof(std::size_t) + std::string_view(t).size();
+	} else {
+		return sizeof(T);
+	}
+}
+
+template <typename T>
+char* encodeArg(char* p, const T& t) {
+	if constexpr(std::is_same_v<LoggedType<T>, std::string_view>) {
+		std::string_view str(t);
+		std::size_t len = str.size();
+		std::memcpy(p, &len, sizeof len);
+		std::memcpy(p + sizeof len, str.data(), len);
+		return p + sizeof len + len;
+	} else {
+		std::memcpy(p, &t, sizeof t);
+		return p + sizeof t;
+	}
+}
+
+template <typename T>
+LoggedType<T> decodeArg(const char*& p) {
+	if constexpr(std::is_same_v<LoggedType<T>, std::string_view>) {
+		std::size_t len;
+		std::memcpy(&len, p, sizeof len);
+		std::string_view str(p + sizeof len, len);
+		p += sizeof len + len;
+		return str;
+	} else {
+		std::decay_t<T> t;
+		std::memcpy(&t, p, sizeof t);
+		p += sizeof t;
+		return t;
+	}
+}
+
+/*
+ * Record header in a ring: the record is size bytes including the header, rounded up to 8.
+ * A header without format function marks the rest of the ring as unused, the next record
+ * is at the start.
+ */
+struct LogRecord {
+	std::size_t size;
+	std::size_t (*format)(const char* fmt, const char* data, BufferSink& sink);
+	const char* fmt;
+};
+
+/* Rebuild the arguments of a record and interpolate them */
+template <typename... Ts>
+std::size_t formatRecord(const char* fmt, [[maybe_unused]] const char* data, BufferSink& sink) {
+	std::tuple<LoggedType<Ts>...> args{decodeArg<Ts>(data)...};
+	return std::apply([&](const auto&... a) { return Interpolate_to(sink, fmt, a...); }, args);
+}
+
+/*
+ * Single producer, single consumer ring of records. The owning thread appends at head,
+ * the logger thread consumes at tail, both only ever grow. The ring is retired when its
+ * thread exits, the logger thread frees it once everything in it is written.
+ */
+class LogRing {
+	public:
+		explicit LogRing(std::size_t c) : buf(new char[c]), cap(c), out(new char[OUT_SIZE]) { }
+
+		/* Reserve size bytes at head, waits while the consumer frees space */
+		char* reserve(std::size_t size) {
+			std::size_t h = head.load(std::memory_order_relaxed);
+			std::size_t pos = h & (cap - 1);
+			std::size_t skip = (cap - pos < size) ? cap - pos : 0;
+			while(h + skip + size - cachedTail > cap) {
+				cachedTail = tail.load(std::memory_order_acquire);
+				if(h + skip + size - cachedTail > cap) {
+					std::this_thread::yield();
+				}
+			}
+			if(skip) {
+				// Too small for a header, the consumer skips it anyway
+				if(skip >= sizeof(LogRecord)) {
+					LogRecord wrap{skip, nullptr, nullptr};
+					std::memcpy(buf.get() + pos, &wrap, sizeof wrap);
+				}
+				pos = 0;
+			}
+			pendingSkip = skip;
+			return buf.get() + pos;
+		}
+
+		/* Make the reserved record visible to the consumer */
+		void publish(std::size_t size) {
+			head.store(head.load(std::memory_order_relaxed) + pendingSkip + size, std::memory_order_release);
+		}
+
+		bool empty() const {
+			return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+		}
+
+		/* Retired, and the last record of its thread consumed */
+		bool isDone() const {
+			return isRetired.load(std::memory_order_acquire) && empty();
+		}
+
+		static constexpr std::size_t OUT_SIZE = 64*1024;
+
+		alignas(64) std::atomic<std::size_t> head{0};
+		std::size_t cachedTail = 0;
+		std::size_t pendingSkip = 0;
+		alignas(64) std::atomic<std::size_t> tail{0};
+		std::unique_ptr<char[]> buf;
+		std::size_t cap;
+		std::atomic<bool> isRetired{false};
+		/* Formatted output waiting for writev(), only used by the logger thread */
+		std::unique_ptr<char[]> out;
+		std::size_t outLen = 0;
+};
+
+/*
+ * Rings of one thread, by id of their logger. When the thread exits its rings are retired,
+ * rings of loggers that are gone have expired already.
+ */
+struct ThreadRings {
+	std::vector<std::pair<std::size_t, std::weak_ptr<LogRing>>> owned;
+	~ThreadRings() {
+		for(auto& o : owned) {
+			if(std::shared_ptr<LogRing> ring = o.second.lock()) {
+				ring->isRetired.store(true, std::memory_order_release);
+			}
+		}
+	}
+};
+
+/*
+ * Asynchronous logger: log() copies the format pointer and the arguments into a ring owned by
+ * the calling thread, a background thread interpolates them and writes the output to fd with
+ * writev(), one buffer per ring. Lines of one thread keep their order, lines of different threads
+ * don't. The format has to outlive the logger and not change, string literals do: it is checked
+ * against the arguments on the first call from a thread, not on every one. When a ring is full the
+ * caller waits for the logger thread.
+ */
+class AsyncLogger {
+	public:
+		explicit AsyncLogger(int fd, std::size_t ringSize = DEFAULT_RING_SIZE)
+			: fd(fd), ringSize(ringSize), id(nextId()), worker(&AsyncLogger::run, this) { }
+
+		AsyncLogger(const AsyncLogger&) = delete;
+		AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+		~AsyncLogger() {
+			isStopping.store(true, std::memory_order_release);
+			worker.join();
+		}
+
+		/* Log one line, returns false if the record doesn't fit in a ring and is dropped */
+		template <typename... Ts>
+		bool log(const char* fmt, const Ts&... args) {
+			static_assert(((std::is_same_v<LoggedType<Ts>, std::string_view> || (std::is_same_v<LoggedType<Ts>, Ts>
+				&& std::is_trivially_copyable_v<Ts> && !isManipulatorType<Ts>() && !IsNamedArg<Ts>::value && !IsJoined<Ts>::value)) && ...),
+				"Only strings and trivially copyable values can be logged, arguments can't be named or joined");
+			bool isManip[sizeof...(Ts) + 1] = {isManipulators(args)...};
+			// Empty strings take no placeholder, so the check depends on which are empty too
+			uint64_t manipMask = 0;
+			for(std::size_t i = 0; i < sizeof...(Ts) && i < 64; i++) {
+				manipMask |= uint64_t(isManip[i]) << i;
+			}
+			// The last format that passed the check on this thread, for these argument types
+			thread_local const char* checkedFmt = nullptr;
+			thread_local uint64_t checkedMask = 0;
+			if(fmt != checkedFmt || manipMask != checkedMask || sizeof...(Ts) > 64) {
+				std::string_view names[sizeof...(Ts) + 1] = {};
+				ParsedFormat scratch;
+				Arguments<sizeof...(Ts)>(isManip, names).check(cachedFormat(fmt, scratch));
+				checkedFmt = fmt;
+				checkedMask = manipMask;
+			}
+			std::size_t size = (sizeof(LogRecord) + (std::size_t(0) + ... + loggedSize(args)) + 7) & ~std::size_t(7);
+			LogRing& ring = threadRing();
+			if(size > ring.cap / 2) {
+				return false;
+			}
+			char* p = ring.reserve(size);
+			LogRecord rec{size, &formatRecord<Ts...>, fmt};
+			std::memcpy(p, &rec, sizeof rec);
+			p += sizeof rec;
+			((p = encodeArg(p, args)), ...);
+			ring.publish(size);
+			return true;
+		}
+
+		/* Wait until everything logged before the call is written */
+		void flush() {
+			// Shared, so that rings retired meanwhile aren't freed under the wait
+			std::vector<std::pair<std::shared_ptr<LogRing>, std::size_t>> marks;
+			{
+				std::lock_guard<std::mutex> lock(ringsMutex);
+				for(auto& r : rings) {
+					marks.emplace_back(r, r->head.load(std::memory_order_acquire));
+				}
+			}
+			for(auto& m : marks) {
+				while(m.first->tail.load(std::memory_order_acquire) < m.second) {
+					std::this_thread::yield();
+				}
+			}
+			// The records are consumed, wait for the pass that consumed them to write them out
+			std::size_t pass = passes.load(std::memory_order_acquire);
+			while(passes.load(std::memory_order_acquire) <= pass) {
+				std::this_thread::yield();
+			}
+		}
+
+		/* Rings of threads that logged and are alive, or exited with lines not written yet */
+		std::size_t ringCount() {
+			std::lock_guard<std::mutex> lock(ringsMutex);
+			return rings.size();
+		}
+
+		static constexpr std::size_t DEFAULT_RING_SIZE = 1 << 20;
+	private:
+		int fd;
+		std::size_t ringSize;
+		std::size_t id;
+		std::atomic<bool> isStopping{false};
+		std::atomic<std::size_t> passes{0};
+		std::mutex ringsMutex;
+		std::vector<std::shared_ptr<LogRing>> rings;
+		std::thread worker;
+
+		static std::size_t nextId() {
+			static std::atomic<std::size_t> ids{1};
+			return ids++;
+		}
+
+		/*
+		 * Ring of the calling thread, the last one used is cached. It stays in rings while the thread
+		 * lives, so the plain pointer is safe.
+		 */
+		LogRing& threadRing() {
+			thread_local std::size_t cachedId = 0;
+			thread_local LogRing* cachedRing = nullptr;
+			if(cachedId == id) {
+				return *cachedRing;
+			}
+			thread_local ThreadRings threadRings;
+			std::vector<std::pair<std::size_t, std::weak_ptr<LogRing>>>& owned = threadRings.owned;
+			owned.erase(std::remove_if(owned.begin(), owned.end(), [](const auto& o) { return o.second.expired(); }), owned.end());
+			LogRing* ring = nullptr;
+			for(auto& o : owned) {
+				if(o.first == id) {
+					ring = o.second.lock().get();
+				}
+			}
+			if(ring == nullptr) {
+				std::size_t cap = 64;
+				while(cap < ringSize) {
+					cap *= 2;
+				}
+				std::lock_guard<std::mutex> lock(ringsMutex);
+				rings.push_back(std::make_shared<LogRing>(cap));
+				ring = rings.back().get();
+				owned.emplace_back(id, rings.back());
+			}
+			cachedId = id;
+			cachedRing = ring;
+			return *ring;
+		}
+
+		/* Format what is in a ring into its output buffer, stops when the buffer is full */
+		void drain(LogRing& r) {
+			std::size_t t = r.tail.load(std::memory_order_relaxed);
+			std::size_t h = r.head.load(std::memory_order_acquire);
+			while(t != h) {
+				std::size_t pos = t & (r.cap - 1);
+				LogRecord rec;
+				if(r.cap - pos < sizeof rec) {
+					t += r.cap - pos;
+					continue;
+				}
+				std::memcpy(&rec, r.buf.get() + pos, sizeof rec);
+				if(rec.format != nullptr) {
+					BufferSink sink(r.out.get() + r.outLen, LogRing::OUT_SIZE - r.outLen);
+					rec.format(rec.fmt, r.buf.get() + pos + sizeof rec, sink);
+					std::size_t len = sink.finish();
+					// Doesn't fit, try again with an empty buffer; longer lines are cut
+					if(r.outLen + len >= LogRing::OUT_SIZE && r.outLen > 0) {
+						break;
+					}
+					r.outLen += (len < LogRing::OUT_SIZE ? len : LogRing::OUT_SIZE - 1);
+				}
+				t += rec.size;
+			}
+			r.tail.store(t, std::memory_order_release);
+		}
+
+		/* writev() all output buffers, retrying on short writes */
+		void writeOut(std::vector<LogRing*>& rs) {
+			std::vector<iovec> iov;
+			for(LogRing* r : rs) {
+				if(r->outLen > 0) {
+					iov.push_back(iovec{r->out.get(), r->outLen});
+				}
+			}
+			std::size_t first = 0;
+			while(first < iov.size()) {
+				int n = int(std::min<std::size_t>(iov.size() - first, IOV_MAX));
+				ssize_t written = ::writev(fd, &iov[first], n);
+				if(written < 0) {
+					if(errno == EINTR) {
+						continue;
+					}
+					break;
+				}
+				while(first < iov.size() && std::size_t(written) >= iov[first].iov_len) {
+					written -= iov[first++].iov_len;
+				}
+				if(first < iov.size()) {
+					iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + written;
+					iov[first].iov_len -= written;
+				}
+			}
+			for(LogRing* r : rs) {
+				r->outLen = 0;
+			}
+		}
+
+		void run() {
+			std::vector<LogRing*> rs;
+			for(;;) {
+				bool isStopped = isStopping.load(std::memory_order_acquire);
+				{
+					std::lock_guard<std::mutex> lock(ringsMutex);
+					rs.clear();
+					for(auto& r : rings) {
+						rs.push_back(r.get());
+					}
+				}
+				bool isIdle = true, isAnyDone = false;
+				for(LogRing* r : rs) {
+					isIdle = isIdle && r->empty();
+					drain(*r);
+				}
+				writeOut(rs);
+				// Free the rings of exited threads, their output is written
+				for(LogRing* r : rs) {
+					isAnyDone = isAnyDone || r->isDone();
+				}
+				if(isAnyDone) {
+					std::lock_guard<std::mutex> lock(ringsMutex);
+					rings.erase(std::remove_if(rings.begin(), rings.end(), [](const auto& r) { return r->isDone(); }), rings.end());
+				}
+				passes.fetch_add(1, std::memory_order_release);
+				if(isIdle) {
+					if(isStopped) {
+						return;
+					}
+					std::this_thread::sleep_for(std::chrono::microseconds(100));
+				}
+			}
+		}
+};
+}
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Latency of cs540::AsyncLogger::log() against std::cout << Interpolate(). Run with
+ *
+ *    -t threads
+ *    -n lines
+ *
+ * to set the number of logging threads (defaults to 1) and the number of lines each of them
+ * logs (defaults to 1000000). Results go to stderr, run with stdout redirected to /dev/null or a
+ * file. Every call is timed on its own, so the numbers include the cost of reading the clock.
+ */
+
+// NOTE compile with -O2 -pthread
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AsyncLogger.hpp"
+
+using clk = std::chrono::steady_clock;
+
+/*
+ * Call log(t, i) n times on each of n_threads threads and print the percentiles of the time
+ * taken by one call.
+ */
+
+template <typename F>
+void
+bench_latency(const char *name, int n_threads, int n, F log) {
+
+    std::vector<std::vector<float>> samples(n_threads);
+    std::vector<std::thread> threads;
+
+    auto start = clk::now();
+    for (int t = 0; t < n_threads; t++) {
+        threads.emplace_back([t, n, &samples, &log]() {
+            std::vector<float> &ns = samples[t];
+            ns.reserve(n);
+            for (int i = 0; i < n; i++) {
+                auto before = clk::now();
+                log(t, i);
+                ns.push_back(std::chrono::duration<float, std::nano>(clk::now() - before).count());
+            }
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    double secs = std::chrono::duration<double>(clk::now() - start).count();
+
+    std::vector<float> all;
+    for (auto &s : samples) {
+        all.insert(all.end(), s.begin(), s.end());
+    }
+    std::sort(all.begin(), all.end());
+    auto pct = [&](double p) { return all[std::size_t(p*(all.size() - 1))]; };
+    fprintf(stderr, "%-28s p50 %8.0f ns  p99 %8.0f ns  p999 %8.0f ns  max %10.0f ns  %12.0f lines/s\n",
+        name, pct(0.5), pct(0.99), pct(0.999), all.back(), all.size()/secs);
+}
+
+int
+main(int argc, char *argv[]) {
+
+    int n_threads = 1;
+    int n = 1000000;
+
+    {
+        int c;
+        while ((c = getopt(argc, argv, "t:n:")) != EOF) {
+            switch (c) {
+                case 't':
+                    n_threads = atoi(optarg);
+                    break;
+                case 'n':
+                    n = atoi(optarg);
+                    break;
+                case '?':
+                    fprintf(stderr, "Unrecog.\n");
+                    exit(1);
+            }
+        }
+    }
+
+    const std::string user("someone");
+
+    fprintf(stderr, "---- %d threads, %d lines each\n", n_threads, n);
+    {
+        int fd = open("/dev/null", O_WRONLY);
+        cs540::AsyncLogger logger(fd);
+        bench_latency("AsyncLogger::log()", n_threads, n, [&](int t, int i) {
+            logger.log("thread=% line=% user=% value=%\n", t, i, user, i*0.5);
+        });
+        logger.flush();
+        close(fd);
+    }
+    {
+        std::mutex mtx;
+        bench_latency("std::cout << Interpolate()", n_threads, n, [&](int t, int i) {
+            std::lock_guard<std::mutex> lock(mtx);
+            std::cout << cs540::Interpolate("thread=% line=% user=% value=%\n", t, i, user, i*0.5);
+        });
+        std::cout.flush();
+    }
+}
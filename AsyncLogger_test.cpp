@@ -0,0 +1,155 @@
+// NOTE compile with -pthread
+#include "AsyncLogger.hpp"
+#include <assert.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Temporary file that is removed when done, the logger writes to fd.
+class TempFile {
+    public:
+        TempFile() {
+            char name[] = "/tmp/AsyncLogger_test.XXXXXX";
+            fd = mkstemp(name);
+            assert(fd >= 0);
+            unlink(name);
+        }
+        ~TempFile() { close(fd); }
+        std::string contents() {
+            std::string str;
+            char buf[4096];
+            ssize_t n;
+            lseek(fd, 0, SEEK_SET);
+            while ((n = read(fd, buf, sizeof buf)) > 0) {
+                str.append(buf, n);
+            }
+            return str;
+        }
+        int fd;
+};
+
+int
+main() {
+
+    // Test that lines come out the same as Interpolate(), with strings copied at the call.
+    {
+        TempFile file;
+        std::stringstream cmp;
+        {
+            cs540::AsyncLogger logger(file.fd);
+            std::string str("foo");
+            logger.log("i=%, x=%, s=%\n", 1, 2.5, str);
+            cmp << cs540::Interpolate("i=%, x=%, s=%\n", 1, 2.5, str);
+            str = "bar";
+            logger.log("% % \\% %%\n", 'c', -1L, std::string(), "literal", 1e-9);
+            cmp << cs540::Interpolate("% % \\% %%\n", 'c', -1L, std::string(), "literal", 1e-9);
+            logger.flush();
+            assert(file.contents() == cmp.str());
+
+            // Written by the destructor.
+            logger.log("last %\n", str);
+            cmp << "last bar\n";
+        }
+        assert(file.contents() == cmp.str());
+    }
+
+    // Test errors.
+    {
+        TempFile file;
+        cs540::AsyncLogger logger(file.fd, 1024);
+        try {
+            logger.log("i=%, j=%\n", 1);
+            assert(false);
+        } catch (cs540::WrongNumberOfArgs &) {
+        }
+        // The check is skipped for a format that passed, unless a string turns empty.
+        const char *fmt = "% %\n";
+        for (const char *str : {"a", "b", "", "c"}) {
+            try {
+                assert(logger.log(fmt, 1, std::string(str)));
+                assert(*str != '\0');
+            } catch (cs540::WrongNumberOfArgs &) {
+                assert(*str == '\0');
+            }
+        }
+        logger.flush();
+        assert(file.contents() == "1 a\n1 b\n1 c\n");
+        // Records longer than half of the ring are dropped.
+        assert(!logger.log("%\n", std::string(1024, 'x')));
+        assert(logger.log("%\n", std::string(100, 'x')));
+        logger.flush();
+        assert(file.contents() == "1 a\n1 b\n1 c\n" + std::string(100, 'x') + "\n");
+    }
+
+    // Test many threads with small rings, so they wrap around and fill up.
+    {
+        const int n_threads = 4, n_lines = 20000;
+        TempFile file;
+        {
+            cs540::AsyncLogger logger(file.fd, 4096);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < n_threads; t++) {
+                threads.emplace_back([t, &logger]() {
+                    for (int i = 0; i < n_lines; i++) {
+                        logger.log("% % %\n", t, i, std::string(i%37 + 1, 'a' + t));
+                    }
+                });
+            }
+            for (auto &th : threads) {
+                th.join();
+            }
+        }
+        std::stringstream lines(file.contents());
+        std::vector<int> next(n_threads);
+        int t, i;
+        std::string str;
+        while (lines >> t >> i) {
+            lines >> str;
+            assert(str == std::string(i%37 + 1, 'a' + t));
+            assert(t >= 0 && t < n_threads && next[t] == i);
+            next[t]++;
+        }
+        for (int n : next) {
+            assert(n == n_lines);
+        }
+    }
+
+    // Test that the rings of threads that exit are freed once their lines are written.
+    {
+        const int n_batches = 50, n_threads = 8;
+        TempFile file;
+        {
+            cs540::AsyncLogger logger(file.fd, 4096);
+            for (int b = 0; b < n_batches; b++) {
+                std::vector<std::thread> threads;
+                for (int t = 0; t < n_threads; t++) {
+                    threads.emplace_back([b, t, &logger]() {
+                        logger.log("% %\n", b, t);
+                        assert(logger.ringCount() <= std::size_t(n_threads));
+                    });
+                }
+                for (auto &th : threads) {
+                    th.join();
+                }
+                // A pass that starts after the threads exited frees their rings.
+                logger.flush();
+                logger.flush();
+                assert(logger.ringCount() == 0);
+            }
+            logger.log("main\n");
+            assert(logger.ringCount() == 1);
+        }
+        std::stringstream lines(file.contents());
+        std::string line;
+        int n = 0;
+        while (std::getline(lines, line)) {
+            n++;
+        }
+        assert(n == n_batches*n_threads + 1);
+    }
+}
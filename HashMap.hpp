@@ -0,0 +1,450 @@
+#ifndef HASHMAP_HPP
+#define HASHMAP_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <new>
+#include <utility>
+#include <stdexcept>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "Murmur3.hpp"
+
+namespace cs540 {
+
+template <class Key_T, class Mapped_T, class Hash> class HashMap;
+template <class Key_T, class Mapped_T, class Hash> bool operator==(const HashMap<Key_T, Mapped_T, Hash> &, const HashMap<Key_T, Mapped_T, Hash> &);
+template <class Key_T, class Mapped_T, class Hash> bool operator!=(const HashMap<Key_T, Mapped_T, Hash> &, const HashMap<Key_T, Mapped_T, Hash> &);
+
+/* -------------------------- Key Hash -------------------------- */
+// Keys are hashed with murmur3<Key_T>, pairs and tuples as the values they hold one after the other.
+// The seed is murmur3_process_seed() unless one is given, so keys picked to collide under a known
+// seed don't pile up in one probe sequence; murmur3_random_seed() gives each map its own.
+struct MurmurSeed {
+	uint32_t seed;
+	MurmurSeed() : seed(murmur3_process_seed()) { }
+	explicit MurmurSeed(uint32_t s) : seed(s) { }
+};
+template <class Key_T>
+struct MurmurHash : MurmurSeed {
+	using MurmurSeed::MurmurSeed;
+	uint32_t operator()(const Key_T & key) const { return murmur3<Key_T>(seed).apply(key); }
+};
+template <class First_T, class Second_T>
+struct MurmurHash<std::pair<First_T, Second_T>> : MurmurSeed {
+	using MurmurSeed::MurmurSeed;
+	uint32_t operator()(const std::pair<First_T, Second_T> & key) const {
+		return murmur3<First_T, Second_T>(seed).apply(key.first, key.second);
+	}
+};
+template <class... Ts>
+struct MurmurHash<std::tuple<Ts...>> : MurmurSeed {
+	using MurmurSeed::MurmurSeed;
+	uint32_t operator()(const std::tuple<Ts...> & key) const {
+		return std::apply([this](const Ts &... values) { return murmur3<Ts...>(seed).apply(values...); }, key);
+	}
+};
+
+/* -------------------------- HashedKey Class -------------------------- */
+/*
+ * Key of Args... that carries its murmur3 hash, worked out once when it is made. Keys that are
+ * looked up again and again, in one map or in several, are serialized and hashed once rather than
+ * on every lookup, and a growing map moves them without hashing them again. The hash is under
+ * murmur3_process_seed(), the seed of maps that don't get one of their own, unless a seed is given.
+ */
+template <class... Args>
+class HashedKey {
+	std::tuple<Args...> keyValues;
+	uint32_t keySeed;
+	uint32_t keyHash;
+	public:
+		explicit HashedKey(const Args &... args) : HashedKey(std::tuple<Args...>(args...), murmur3_process_seed()) { }
+		HashedKey(const std::tuple<Args...> & values, uint32_t seed)
+			: keyValues(values), keySeed(seed), keyHash(MurmurHash<std::tuple<Args...>>(seed)(values)) { }
+		const std::tuple<Args...> & values() const { return keyValues; }
+		template <std::size_t I>
+		const auto & get() const { return std::get<I>(keyValues); }
+		uint32_t seed() const { return keySeed; }
+		uint32_t hash() const { return keyHash; }
+		// Keys with different hashes under the same seed differ, without comparing their values
+		friend bool operator==(const HashedKey & k1, const HashedKey & k2) {
+			return (k1.keySeed != k2.keySeed || k1.keyHash == k2.keyHash) && k1.keyValues == k2.keyValues;
+		}
+		friend bool operator!=(const HashedKey & k1, const HashedKey & k2) { return !(k1 == k2); }
+};
+
+// The carried hash when it is under the seed of the map, else the hash of the values
+template <class... Ts>
+struct MurmurHash<HashedKey<Ts...>> : MurmurSeed {
+	using MurmurSeed::MurmurSeed;
+	uint32_t operator()(const HashedKey<Ts...> & key) const {
+		if(key.seed() == seed) return key.hash();
+		return MurmurHash<std::tuple<Ts...>>(seed)(key.values());
+	}
+};
+
+/* -------------------------- Control Bytes -------------------------- */
+// One byte per slot: EMPTY, DELETED, or the low 7 bits of the hash of the key in the slot.
+// END follows the last slot and stops iterators.
+#define HASH_EMPTY int8_t(-128)
+#define HASH_DELETED int8_t(-2)
+#define HASH_END int8_t(-1)
+#define HASH_GROUP 16
+
+struct HashGroup {
+	// Bit i is set when byte i of the 16 at ctrl is h2
+	static uint32_t match(const int8_t* ctrl, int8_t h2) {
+#if defined(__SSE2__)
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2)));
+#else
+		uint32_t mask = 0;
+		for(int i = 0; i < HASH_GROUP; i++) mask |= uint32_t(ctrl[i] == h2) << i;
+		return mask;
+#endif
+	}
+	static uint32_t matchEmpty(const int8_t* ctrl) { return match(ctrl, HASH_EMPTY); }
+	// EMPTY and DELETED, the bytes below END
+	static uint32_t matchFree(const int8_t* ctrl) {
+#if defined(__SSE2__)
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+		return _mm_movemask_epi8(_mm_cmplt_epi8(bytes, _mm_set1_epi8(HASH_END)));
+#else
+		uint32_t mask = 0;
+		for(int i = 0; i < HASH_GROUP; i++) mask |= uint32_t(ctrl[i] < HASH_END) << i;
+		return mask;
+#endif
+	}
+	static uint32_t matchFullOrEnd(const int8_t* ctrl) { return ~matchFree(ctrl) & 0xffff; }
+	// Control bytes of a map without slots, so that empty maps don't allocate
+	static const int8_t* emptyGroup() {
+		alignas(16) static const int8_t group[HASH_GROUP] = {HASH_END, HASH_EMPTY, HASH_EMPTY, HASH_EMPTY,
+			HASH_EMPTY, HASH_EMPTY, HASH_EMPTY, HASH_EMPTY, HASH_EMPTY, HASH_EMPTY, HASH_EMPTY,
+			HASH_EMPTY, HASH_EMPTY, HASH_EMPTY, HASH_EMPTY, HASH_EMPTY};
+		return group;
+	}
+};
+
+/* -------------------------- HashMap Class -------------------------- */
+/*
+ * Unordered map with open addressing. Slots are in groups of 16 with one control byte each, a
+ * lookup compares 7 bits of the hash against a whole group at once (with SSE2) and only compares
+ * keys where they match. Groups are probed in triangular steps until a group with an empty slot.
+ * Same interface as Map, but iterators go through the slots in no particular order and are
+ * invalidated when an insert grows the table.
+ */
+template <class Key_T, class Mapped_T, class Hash = MurmurHash<typename std::remove_const<Key_T>::type>>
+class HashMap {
+	typedef std::pair<Key_T, Mapped_T> ValueType;
+	private:
+		int8_t* ctrl = const_cast<int8_t*>(HashGroup::emptyGroup()); // capacity + 16 bytes
+		ValueType* slots = NULL;
+		std::size_t capacity = 0; // 0 or a power of two of at least 16
+		std::size_t count = 0;
+		std::size_t growthLeft = 0; // Inserts into empty slots left before the table grows
+		Hash hasher;
+		static int8_t h2(uint32_t hash) { return int8_t(hash & 0x7f); }
+		static std::size_t maxLoad(std::size_t cap) { return cap - cap/8; }
+		std::size_t findIndex(const Key_T &, uint32_t) const;
+		std::size_t findFree(uint32_t) const;
+		void rehash(std::size_t);
+		void prepareInsert();
+		void eraseIndex(std::size_t);
+		void freeTable();
+	public:
+		/* ----------------------- Iterator Class ---------------------- */
+		class Iterator {
+			public:
+			const int8_t* current; // Control byte of the slot
+			ValueType* slot;
+			// Skip to the next full slot or END
+			void skipFree() {
+				for(;;) {
+					uint32_t mask = HashGroup::matchFullOrEnd(current);
+					if(mask != 0) {
+						int n = __builtin_ctz(mask);
+						current += n;
+						slot += n;
+						return;
+					}
+					current += HASH_GROUP;
+					slot += HASH_GROUP;
+				}
+			}
+			Iterator & operator++() { ++current; ++slot; skipFree(); return *this; }
+			Iterator operator++(int) {
+				Iterator it = *this;
+				++*this;
+				return it;
+			}
+			ValueType & operator*() const { return *slot; }
+			ValueType * operator->() const { return slot; }
+		};
+		/* ----------------------- Const Iterator Class ----------------------- */
+		class ConstIterator {
+			public:
+			Iterator it;
+			ConstIterator(const Iterator & i) : it(i) { }
+			ConstIterator & operator++() { ++it; return *this; }
+			ConstIterator operator++(int) {
+				ConstIterator c = *this;
+				++it;
+				return c;
+			}
+			const ValueType & operator*() const { return *it.slot; }
+			const ValueType * operator->() const { return it.slot; }
+		};
+	public:
+		HashMap() { }
+		// Keys hashed with hash, e.g. MurmurHash<Key_T>(murmur3_random_seed()) for a seed of its own
+		explicit HashMap(const Hash & hash) : hasher(hash) { }
+		HashMap(const HashMap &);
+		HashMap(HashMap && obj) { *this = std::move(obj); }
+		HashMap & operator=(const HashMap &);
+		HashMap & operator=(HashMap &&);
+		HashMap(std::initializer_list<std::pair<const Key_T, Mapped_T>>);
+		~HashMap() { freeTable(); }
+
+		int size() const { return int(count); }
+		bool empty() const { return count == 0; }
+		const Hash & hashFunction() const { return hasher; }
+		// Make room for n entries without growing again
+		void reserve(std::size_t n) {
+			std::size_t cap = HASH_GROUP;
+			while(maxLoad(cap) < n) cap *= 2;
+			if(cap > capacity) rehash(cap);
+		}
+		Iterator begin() {
+			Iterator it{ctrl, slots};
+			it.skipFree();
+			return it;
+		}
+		Iterator end() { return Iterator{ctrl + capacity, slots + capacity}; }
+		ConstIterator begin() const { return const_cast<HashMap *>(this)->begin(); }
+		ConstIterator end() const { return const_cast<HashMap *>(this)->end(); }
+		Iterator find(const Key_T & key) {
+			std::size_t i = findIndex(key, hasher(key));
+			return Iterator{ctrl + i, slots + i};
+		}
+		ConstIterator find(const Key_T & key) const { return const_cast<HashMap *>(this)->find(key); }
+		Mapped_T & at(const Key_T & key) {
+			std::size_t i = findIndex(key, hasher(key));
+			if(i == capacity) throw std::out_of_range("Not Found!");
+			return slots[i].second;
+		}
+		const Mapped_T & at(const Key_T & key) const { return const_cast<HashMap *>(this)->at(key); }
+		Mapped_T & operator[](const Key_T &);
+		std::pair<Iterator, bool> insert(const ValueType &);
+		void erase(const Key_T & key) {
+			std::size_t i = findIndex(key, hasher(key));
+			if(i != capacity) eraseIndex(i);
+		}
+		void erase(Iterator pos) { eraseIndex(pos.current - ctrl); }
+		void clear();
+
+		friend bool operator== <>(const HashMap &, const HashMap &);
+		friend bool operator!= <>(const HashMap &, const HashMap &);
+
+		friend bool operator==(const Iterator & it1, const Iterator & it2) { return it1.current == it2.current; }
+		friend bool operator==(const ConstIterator & it1, const ConstIterator & it2) { return it1.it.current == it2.it.current; }
+		friend bool operator==(const Iterator & it1, const ConstIterator & it2) { return it1.current == it2.it.current; }
+		friend bool operator==(const ConstIterator & it1, const Iterator & it2) { return it1.it.current == it2.current; }
+		friend bool operator!=(const Iterator & it1, const Iterator & it2) { return it1.current != it2.current; }
+		friend bool operator!=(const ConstIterator & it1, const ConstIterator & it2) { return it1.it.current != it2.it.current; }
+		friend bool operator!=(const Iterator & it1, const ConstIterator & it2) { return it1.current != it2.it.current; }
+		friend bool operator!=(const ConstIterator & it1, const Iterator & it2) { return it1.it.current != it2.current; }
+};
+
+/*------------------------ HashMap class method(s) ---------------------------------*/
+/* Slot of key, or capacity if it is not in the map */
+template <class Key_T, class Mapped_T, class Hash>
+std::size_t HashMap<Key_T, Mapped_T, Hash> :: findIndex(const Key_T & key, uint32_t hash) const {
+	if(capacity == 0) return 0;
+	std::size_t groupMask = capacity/HASH_GROUP - 1;
+	std::size_t g = (hash >> 7) & groupMask;
+	for(std::size_t step = 1; ; step++) {
+		const int8_t* group = ctrl + g*HASH_GROUP;
+		for(uint32_t mask = HashGroup::match(group, h2(hash)); mask != 0; mask &= mask - 1) {
+			std::size_t i = g*HASH_GROUP + __builtin_ctz(mask);
+			if(slots[i].first == key) return i;
+		}
+		// The key would have been put in the empty slot
+		if(HashGroup::matchEmpty(group) != 0) return capacity;
+		g = (g + step) & groupMask;
+	}
+}
+
+/* First empty or deleted slot on the probe sequence of hash, there always is one */
+template <class Key_T, class Mapped_T, class Hash>
+std::size_t HashMap<Key_T, Mapped_T, Hash> :: findFree(uint32_t hash) const {
+	std::size_t groupMask = capacity/HASH_GROUP - 1;
+	std::size_t g = (hash >> 7) & groupMask;
+	for(std::size_t step = 1; ; step++) {
+		uint32_t mask = HashGroup::matchFree(ctrl + g*HASH_GROUP);
+		if(mask != 0) return g*HASH_GROUP + __builtin_ctz(mask);
+		g = (g + step) & groupMask;
+	}
+}
+
+/* Move every entry into a new table of cap slots, which also drops the deleted slots */
+template <class Key_T, class Mapped_T, class Hash>
+void HashMap<Key_T, Mapped_T, Hash> :: rehash(std::size_t cap) {
+	int8_t* newCtrl = new int8_t[cap + HASH_GROUP];
+	ValueType* newSlots = static_cast<ValueType*>(::operator new(cap*sizeof(ValueType)));
+	memset(newCtrl, HASH_EMPTY, cap + HASH_GROUP);
+	newCtrl[cap] = HASH_END;
+	int8_t* oldCtrl = ctrl;
+	ValueType* oldSlots = slots;
+	std::size_t oldCapacity = capacity;
+	ctrl = newCtrl;
+	slots = newSlots;
+	capacity = cap;
+	growthLeft = maxLoad(cap) - count;
+	for(std::size_t i = 0; i < oldCapacity; i++) {
+		if(oldCtrl[i] < 0) continue;
+		uint32_t hash = hasher(oldSlots[i].first);
+		std::size_t j = findFree(hash);
+		new(&slots[j]) ValueType(std::move_if_noexcept(oldSlots[i]));
+		oldSlots[i].~ValueType();
+		ctrl[j] = h2(hash);
+	}
+	if(oldCapacity != 0) {
+		delete[] oldCtrl;
+		::operator delete(oldSlots);
+	}
+}
+
+/* Make sure an insert into an empty slot doesn't go over the maximum load */
+template <class Key_T, class Mapped_T, class Hash>
+void HashMap<Key_T, Mapped_T, Hash> :: prepareInsert() {
+	if(growthLeft != 0) return;
+	// Mostly deleted slots, cleaning them up in place is enough
+	if(capacity != 0 && count < maxLoad(capacity)/2) rehash(capacity);
+	else rehash(capacity == 0 ? HASH_GROUP : capacity*2);
+}
+
+/*
+ * Destroy the entry in slot i. The slot can only become empty again if its group has an empty
+ * slot, otherwise a probe may have gone past the group to find a key.
+ */
+template <class Key_T, class Mapped_T, class Hash>
+void HashMap<Key_T, Mapped_T, Hash> :: eraseIndex(std::size_t i) {
+	slots[i].~ValueType();
+	count--;
+	if(HashGroup::matchEmpty(ctrl + (i & ~std::size_t(HASH_GROUP - 1))) != 0) {
+		ctrl[i] = HASH_EMPTY;
+		growthLeft++;
+	} else {
+		ctrl[i] = HASH_DELETED;
+	}
+}
+
+template <class Key_T, class Mapped_T, class Hash>
+void HashMap<Key_T, Mapped_T, Hash> :: freeTable() {
+	if(capacity == 0) return;
+	clear();
+	delete[] ctrl;
+	::operator delete(slots);
+	ctrl = const_cast<int8_t*>(HashGroup::emptyGroup());
+	slots = NULL;
+	capacity = 0;
+	growthLeft = 0;
+}
+
+/* Destroy all entries, the table keeps its size */
+template <class Key_T, class Mapped_T, class Hash>
+void HashMap<Key_T, Mapped_T, Hash> :: clear() {
+	if(capacity == 0) return;
+	for(std::size_t i = 0; i < capacity; i++) {
+		if(ctrl[i] >= 0) slots[i].~ValueType();
+	}
+	memset(ctrl, HASH_EMPTY, capacity);
+	count = 0;
+	growthLeft = maxLoad(capacity);
+}
+
+template <class Key_T, class Mapped_T, class Hash>
+std::pair<typename HashMap<Key_T, Mapped_T, Hash>::Iterator, bool> HashMap<Key_T, Mapped_T, Hash> :: insert(const ValueType & value) {
+	uint32_t hash = hasher(value.first);
+	std::size_t i = findIndex(value.first, hash);
+	if(i != capacity) return std::make_pair(Iterator{ctrl + i, slots + i}, false);
+	prepareInsert();
+	i = findFree(hash);
+	new(&slots[i]) ValueType(value);
+	if(ctrl[i] == HASH_EMPTY) growthLeft--;
+	ctrl[i] = h2(hash);
+	count++;
+	return std::make_pair(Iterator{ctrl + i, slots + i}, true);
+}
+
+template <class Key_T, class Mapped_T, class Hash>
+Mapped_T & HashMap<Key_T, Mapped_T, Hash> :: operator[](const Key_T & key) {
+	std::size_t i = findIndex(key, hasher(key));
+	if(i != capacity) return slots[i].second;
+	return insert(ValueType(key, Mapped_T())).first->second;
+}
+
+/* Copy constructor */
+template <class Key_T, class Mapped_T, class Hash>
+HashMap<Key_T, Mapped_T, Hash> :: HashMap(const HashMap & obj) : hasher(obj.hasher) {
+	reserve(obj.count);
+	for(const auto & value : obj) insert(value);
+}
+
+template <class Key_T, class Mapped_T, class Hash>
+HashMap<Key_T, Mapped_T, Hash> :: HashMap(std::initializer_list<std::pair<const Key_T, Mapped_T>> list) {
+	reserve(list.size());
+	for(const auto & value : list) insert(ValueType(value.first, value.second));
+}
+
+/* Copy assignment operator */
+template <class Key_T, class Mapped_T, class Hash>
+HashMap<Key_T, Mapped_T, Hash> & HashMap<Key_T, Mapped_T, Hash> :: operator=(const HashMap & obj) {
+	if(this == &obj) return *this;
+	clear();
+	hasher = obj.hasher;
+	reserve(obj.count);
+	for(const auto & value : obj) insert(value);
+	return *this;
+}
+
+/* Move assignment operator, the table is taken over as it is */
+template <class Key_T, class Mapped_T, class Hash>
+HashMap<Key_T, Mapped_T, Hash> & HashMap<Key_T, Mapped_T, Hash> :: operator=(HashMap && obj) {
+	if(this == &obj) return *this;
+	freeTable();
+	ctrl = obj.ctrl;
+	slots = obj.slots;
+	capacity = obj.capacity;
+	count = obj.count;
+	growthLeft = obj.growthLeft;
+	hasher = std::move(obj.hasher);
+	obj.ctrl = const_cast<int8_t*>(HashGroup::emptyGroup());
+	obj.slots = NULL;
+	obj.capacity = obj.count = obj.growthLeft = 0;
+	return *this;
+}
+
+/* ------------------------ Operator Overloading ---------------------------  */
+/* Same entries, in whatever order they are stored */
+template <class Key_T, class Mapped_T, class Hash>
+bool operator==(const HashMap<Key_T, Mapped_T, Hash> & m1, const HashMap<Key_T, Mapped_T, Hash> & m2) {
+	if(&m1 == &m2) return true;
+	if(m1.size() != m2.size()) return false;
+	for(const auto & value : m1) {
+		auto it = m2.find(value.first);
+		if(it == m2.end() || !(it->second == value.second)) return false;
+	}
+	return true;
+}
+
+template <class Key_T, class Mapped_T, class Hash>
+bool operator!=(const HashMap<Key_T, Mapped_T, Hash> & m1, const HashMap<Key_T, Mapped_T, Hash> & m2) {
+	return !(m1 == m2);
+}
+}
+#endif
@@ -0,0 +1,262 @@
+/*
+ * Inserts and lookups in cs540::HashMap against cs540::Map and std::unordered_map. Run with
+ *
+ *    -n entries
+ *    -c crafted keys
+ *    -d distinct keys
+ *
+ * to set the number of entries in each map (defaults to 1000000), the number of keys crafted to
+ * collide under seed 0 (defaults to 20000) and the number of distinct (user, session, topic) keys
+ * that n requests look up over and over (defaults to 10000).
+ */
+
+// NOTE compile with -O2
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "HashMap.hpp"
+#include "Map.hpp"
+
+static std::chrono::steady_clock::time_point start;
+
+void
+begin_timer() {
+    start = std::chrono::steady_clock::now();
+}
+
+void
+report(const char *name, long ops, long check) {
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-44s %10.3f ms  %8.1f ns/op  (%ld)\n", name, secs*1e3, secs*1e9/ops, check);
+}
+
+/*
+ * cs540::Map returns the tail from find() and std::unordered_map has no at() that doesn't throw,
+ * so lookups go through find() and end() on all of them.
+ */
+
+template <typename MAP_T, typename K>
+void
+bench_map(const char *name, const std::vector<K> &keys, const std::vector<K> &misses) {
+
+    char label[64];
+    MAP_T map;
+    begin_timer();
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        map.insert(std::make_pair(keys[i], int(i)));
+    }
+    snprintf(label, sizeof label, "%s insert()", name);
+    report(label, keys.size(), map.size());
+
+    long sum = 0;
+    begin_timer();
+    for (auto &k : keys) {
+        sum += map.find(k)->second;
+    }
+    snprintf(label, sizeof label, "%s find() hit", name);
+    report(label, keys.size(), sum);
+
+    long found = 0;
+    begin_timer();
+    for (auto &k : misses) {
+        found += map.find(k) != map.end();
+    }
+    snprintf(label, sizeof label, "%s find() miss", name);
+    report(label, misses.size(), found);
+
+    begin_timer();
+    for (auto &k : keys) {
+        map.erase(k);
+    }
+    snprintf(label, sizeof label, "%s erase()", name);
+    report(label, keys.size(), map.size());
+}
+
+/*
+ * Each request looks its key up in three maps. lookup(map, i) finds the key of request i in a
+ * map, hashing it or not. reused_per_request is how many hashes of the three come from a key
+ * hashed before.
+ */
+
+template <typename MAP_T, typename E, typename L>
+void
+bench_requests(const char *name, const std::vector<E> &entries, int n, int reused_per_request, L lookup) {
+
+    MAP_T sessions, limits, topics;
+    for (auto &e : entries) {
+        sessions.insert(e);
+        limits.insert(e);
+        topics.insert(e);
+    }
+    long sum = 0;
+    begin_timer();
+    for (int i = 0; i < n; i++) {
+        sum += lookup(sessions, i) + lookup(limits, i) + lookup(topics, i);
+    }
+    char label[64];
+    snprintf(label, sizeof label, "%s, %d%% of hashes reused", name, reused_per_request*100/3);
+    report(label, n, sum);
+}
+
+/*
+ * Hashes with a fixed seed of 0, and with a seed of each map's own.
+ */
+
+struct ZeroSeedHash : cs540::MurmurHash<uint64_t> {
+    ZeroSeedHash() : cs540::MurmurHash<uint64_t>(0) {}
+};
+
+struct OwnSeedHash : cs540::MurmurHash<uint64_t> {
+    OwnSeedHash() : cs540::MurmurHash<uint64_t>(murmur3_random_seed()) {}
+};
+
+int
+main(int argc, char *argv[]) {
+
+    int n = 1000000;
+    int n_crafted = 20000;
+    int n_distinct = 10000;
+
+    {
+        int c;
+        while ((c = getopt(argc, argv, "n:c:d:")) != EOF) {
+            switch (c) {
+                case 'n':
+                    n = atoi(optarg);
+                    break;
+                case 'c':
+                    n_crafted = atoi(optarg);
+                    break;
+                case 'd':
+                    n_distinct = atoi(optarg);
+                    break;
+                case '?':
+                    fprintf(stderr, "Unrecog.\n");
+                    exit(1);
+            }
+        }
+    }
+
+    srand48(1234);
+
+    // Random keys in random order, the misses are keys that are not in the maps.
+    std::vector<int> keys, misses;
+    {
+        std::unordered_map<int, int> seen;
+        while (int(keys.size()) < n) {
+            int k = int(lrand48());
+            if (seen.insert(std::make_pair(k, 0)).second) {
+                keys.push_back(k);
+            }
+        }
+        while (int(misses.size()) < n) {
+            int k = int(lrand48());
+            if (seen.find(k) == seen.end()) {
+                misses.push_back(k);
+            }
+        }
+    }
+
+    printf("---- %d int keys\n", n);
+    bench_map<cs540::HashMap<const int, int>>("cs540::HashMap", keys, misses);
+    bench_map<std::unordered_map<int, int>>("std::unordered_map", keys, misses);
+    bench_map<std::unordered_map<int, int, cs540::MurmurHash<int>>>("std::unordered_map (MurmurHash)", keys, misses);
+    bench_map<cs540::Map<const int, int>>("cs540::Map", keys, misses);
+
+    // Composite keys: a short string and a number.
+    using key_t = std::tuple<std::string, int>;
+    std::vector<key_t> tuple_keys, tuple_misses;
+    for (int i = 0; i < n; i++) {
+        tuple_keys.emplace_back("user" + std::to_string(keys[i] % 1000), keys[i]);
+        tuple_misses.emplace_back("user" + std::to_string(misses[i] % 1000), misses[i]);
+    }
+
+    printf("---- %d (string, int) keys\n", n);
+    bench_map<cs540::HashMap<const key_t, int>>("cs540::HashMap", tuple_keys, tuple_misses);
+    bench_map<std::unordered_map<key_t, int, cs540::MurmurHash<key_t>>>("std::unordered_map (MurmurHash)", tuple_keys, tuple_misses);
+    bench_map<cs540::Map<const key_t, int>>("cs540::Map", tuple_keys, tuple_misses);
+
+    /*
+     * Keys whose murmur3 under seed 0 has 12 bits in a row the same, the bits that pick the group of
+     * tables of up to 64K slots. Anyone who knows the seed finds them in a few thousand hashes each.
+     */
+    std::vector<uint64_t> crafted, crafted_misses, plain, plain_misses;
+    for (uint64_t k = 0; int(crafted_misses.size()) < n_crafted; k++) {
+        if ((murmur3_hash(k) >> 7 & 0xfff) == 0) {
+            (int(crafted.size()) < n_crafted ? crafted : crafted_misses).push_back(k);
+        }
+    }
+    for (int i = 0; i < n_crafted && i < n; i++) {
+        plain.push_back(uint64_t(keys[i]));
+        plain_misses.push_back(uint64_t(misses[i]));
+    }
+
+    printf("---- %d uint64_t keys crafted to collide under seed 0\n", n_crafted);
+    bench_map<cs540::HashMap<const uint64_t, int, ZeroSeedHash>>("seed 0, random keys", plain, plain_misses);
+    bench_map<cs540::HashMap<const uint64_t, int, ZeroSeedHash>>("seed 0, crafted keys", crafted, crafted_misses);
+    bench_map<cs540::HashMap<const uint64_t, int>>("process seed, crafted keys", crafted, crafted_misses);
+    bench_map<cs540::HashMap<const uint64_t, int, OwnSeedHash>>("own seed, crafted keys", crafted, crafted_misses);
+
+    // Keys that carry their hash, against the same keys as tuples.
+    using hashed_t = cs540::HashedKey<std::string, int>;
+    std::vector<hashed_t> hashed_keys, hashed_misses;
+    for (int i = 0; i < n; i++) {
+        hashed_keys.emplace_back(std::get<0>(tuple_keys[i]), std::get<1>(tuple_keys[i]));
+        hashed_misses.emplace_back(std::get<0>(tuple_misses[i]), std::get<1>(tuple_misses[i]));
+    }
+
+    printf("---- %d HashedKey<string, int> keys\n", n);
+    bench_map<cs540::HashMap<const hashed_t, int>>("cs540::HashMap", hashed_keys, hashed_misses);
+    bench_map<std::unordered_map<hashed_t, int, cs540::MurmurHash<hashed_t>>>("std::unordered_map (MurmurHash)", hashed_keys, hashed_misses);
+
+    /*
+     * Requests for a few distinct (user, session, topic) keys, the busiest users far more often,
+     * each looked up in three maps: as a tuple hashed on every lookup, as a HashedKey made for the
+     * request and hashed once, and as a HashedKey the caller keeps from one request to the next.
+     */
+    using request_t = std::tuple<std::string, std::string, std::string>;
+    using hashed_request_t = cs540::HashedKey<std::string, std::string, std::string>;
+    std::vector<request_t> distinct;
+    std::vector<hashed_request_t> distinct_hashed;
+    std::vector<std::pair<const request_t, int>> request_entries;
+    std::vector<std::pair<const hashed_request_t, int>> hashed_entries;
+    for (int i = 0; i < n_distinct; i++) {
+        distinct.emplace_back("user" + std::to_string(i), "s" + std::to_string(i*7919 % 100000), "topic" + std::to_string(i % 50));
+        distinct_hashed.emplace_back(distinct.back(), murmur3_process_seed());
+        request_entries.emplace_back(distinct.back(), i);
+        hashed_entries.emplace_back(distinct_hashed.back(), i);
+    }
+    std::vector<int> requests(n);
+    for (int i = 0; i < n; i++) {
+        requests[i] = int(lrand48() % (1 + lrand48() % n_distinct));
+    }
+
+    printf("---- %d requests for %d (string, string, string) keys, in 3 maps each\n", n, n_distinct);
+    bench_requests<cs540::HashMap<const request_t, int>>("tuple", request_entries, n, 0,
+        [&](const cs540::HashMap<const request_t, int> &map, int i) {
+            return map.find(distinct[requests[i]])->second;
+        });
+    {
+        // The key of the last request, made again when the request is for another key
+        int last = -1;
+        hashed_request_t key = distinct_hashed[0];
+        bench_requests<cs540::HashMap<const hashed_request_t, int>>("HashedKey a request", hashed_entries, n, 2,
+            [&](const cs540::HashMap<const hashed_request_t, int> &map, int i) {
+                if (i != last) {
+                    key = hashed_request_t(distinct[requests[i]], murmur3_process_seed());
+                    last = i;
+                }
+                return map.find(key)->second;
+            });
+    }
+    bench_requests<cs540::HashMap<const hashed_request_t, int>>("HashedKey kept", hashed_entries, n, 3,
+        [&](const cs540::HashMap<const hashed_request_t, int> &map, int i) {
+            return map.find(distinct_hashed[requests[i]])->second;
+        });
+}
@@ -0,0 +1,260 @@
+/*
+ * Run with
+ *
+ *    -i iterations
+ *
+ * to set the number of random operations of the stress test (defaults to 1000000).
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "HashMap.hpp"
+
+/*
+ * Key without default constructor or assignment, with a hash that puts every key in one of a
+ * few groups, so that probes go through full groups and past deleted slots.
+ */
+
+struct Clumped {
+    friend bool operator==(const Clumped &c1, const Clumped &c2) {
+        return c1.num == c2.num;
+    }
+    explicit Clumped(int n) : num(n) {}
+    Clumped &operator=(const Clumped &) = delete;
+    const int num;
+};
+
+struct ClumpedHash {
+    uint32_t operator()(const Clumped &c) const {
+        return uint32_t(c.num % 4) << 7 | uint32_t(c.num % 128);
+    }
+};
+
+void
+test_basics() {
+
+    cs540::HashMap<const int, int> map;
+    assert(map.empty() && map.size() == 0 && map.begin() == map.end());
+    assert(map.find(1) == map.end());
+    map.erase(1);
+
+    for (int i = 0; i < 1000; i++) {
+        auto r = map.insert(std::make_pair(i, 2*i));
+        assert(r.second && r.first->first == i && r.first->second == 2*i);
+    }
+    assert(map.size() == 1000);
+    auto r = map.insert(std::make_pair(7, 0));
+    assert(!r.second && r.first->second == 14);
+
+    for (int i = 0; i < 1000; i++) {
+        assert(map.at(i) == 2*i && map.find(i)->second == 2*i);
+    }
+    try {
+        map.at(1000);
+        assert(false);
+    } catch (std::out_of_range &) {
+    }
+    map[1000] = 5;
+    map[1001]++;
+    assert(map.at(1000) == 5 && map.at(1001) == 1 && map.size() == 1002);
+
+    // Iteration sees every entry once.
+    long sum = 0;
+    int n = 0;
+    for (auto &e : map) {
+        sum += e.first;
+        n++;
+    }
+    assert(n == 1002 && sum == 999L*1000/2 + 1000 + 1001);
+
+    for (int i = 0; i < 1000; i += 2) {
+        map.erase(i);
+    }
+    map.erase(map.find(1));
+    assert(map.size() == 1002 - 501);
+    assert(map.find(0) == map.end() && map.find(1) == map.end() && map.at(3) == 6);
+
+    // Copies compare equal whatever order their entries are in.
+    cs540::HashMap<const int, int> copy(map), other;
+    assert(copy == map);
+    for (int i = 1001; i >= 0; i--) {
+        auto it = map.find(i);
+        if (it != map.end()) {
+            other.insert(*it);
+        }
+    }
+    assert(other == map);
+    other[3] = 0;
+    assert(other != map);
+
+    const cs540::HashMap<const int, int> moved(std::move(copy));
+    assert(copy.empty() && copy.begin() == copy.end() && moved == map);
+    assert(moved.at(5) == 10 && moved.find(4) == moved.end());
+    copy = moved;
+    assert(copy == map);
+
+    map.clear();
+    assert(map.empty() && map.begin() == map.end() && map.find(3) == map.end());
+
+    cs540::HashMap<const std::string, int> list{{"one", 1}, {"two", 2}, {"three", 3}};
+    assert(list.size() == 3 && list.at("two") == 2 && list["four"] == 0 && list.size() == 4);
+}
+
+void
+test_composite_keys() {
+
+    // Tuples and pairs are hashed as their values, the same as murmur3<Args...> under the seed.
+    using key_t = std::tuple<std::string, int, double>;
+    assert(cs540::MurmurHash<key_t>()(key_t("orders", 3, 0.5))
+        == (murmur3<std::string, int, double>(murmur3_process_seed()).apply("orders", 3, 0.5)));
+    assert((cs540::MurmurHash<std::pair<int, char>>(0)(std::make_pair(1, 'x')) == murmur3_hash(1, 'x')));
+
+    cs540::HashMap<const key_t, int> map;
+    for (int i = 0; i < 500; i++) {
+        map.insert(std::make_pair(key_t(std::to_string(i % 10), i, i*0.5), i));
+    }
+    for (int i = 0; i < 500; i++) {
+        assert(map.at(key_t(std::to_string(i % 10), i, i*0.5)) == i);
+    }
+    assert(map.find(key_t("1", 1, 1.0)) == map.end());
+}
+
+void
+test_hashed_keys() {
+
+    // The carried hash is the hash of the values under the seed.
+    using key_t = cs540::HashedKey<std::string, int>;
+    const key_t key("orders", 3), other("orders", 4), seeded(std::make_tuple(std::string("orders"), 3), 7);
+    assert(key.seed() == murmur3_process_seed() && key.get<0>() == "orders" && key.get<1>() == 3);
+    assert(key.hash() == (murmur3<std::string, int>(murmur3_process_seed()).apply("orders", 3)));
+    assert(seeded.seed() == 7 && seeded.hash() == (murmur3<std::string, int>(7).apply("orders", 3)));
+    assert(key == key_t("orders", 3) && key != other && key == seeded);
+    assert(cs540::MurmurHash<key_t>()(key) == key.hash() && cs540::MurmurHash<key_t>(7)(key) == seeded.hash());
+
+    // Keys found whatever seed they carry, in maps of the process seed and of their own.
+    cs540::HashMap<const key_t, int> map, own(cs540::MurmurHash<key_t>{7});
+    for (int i = 0; i < 500; i++) {
+        map.insert(std::make_pair(key_t(std::to_string(i % 10), i), i));
+        own.insert(std::make_pair(key_t(std::make_tuple(std::to_string(i % 10), i), 7), i));
+    }
+    for (int i = 0; i < 500; i++) {
+        const key_t k(std::to_string(i % 10), i), k7(std::make_tuple(std::to_string(i % 10), i), 7);
+        assert(map.at(k) == i && map.at(k7) == i && own.at(k) == i && own.at(k7) == i);
+    }
+    assert(map.find(key_t("1", 2)) == map.end() && own.find(key_t("1", 2)) == own.end());
+}
+
+/*
+ * Keys whose hashes under seed 0 all pick the same group, as someone who knows the seed could send.
+ * Under seed 0 they share one probe sequence, under any other seed they spread out.
+ */
+
+void
+test_seeds() {
+
+    std::vector<uint64_t> keys;
+    for (uint64_t k = 0; keys.size() < 300; k++) {
+        if ((murmur3_hash(k) >> 7 & 0xfff) == 0) {
+            keys.push_back(k);
+        }
+    }
+
+    const uint32_t seed = murmur3_random_seed();
+    using hash_t = cs540::MurmurHash<uint64_t>;
+    cs540::HashMap<const uint64_t, int> fixed(hash_t{0}), own(hash_t{seed}), process;
+    assert(fixed.hashFunction().seed == 0 && own.hashFunction().seed == seed);
+    assert(process.hashFunction().seed == murmur3_process_seed());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        fixed.insert(std::make_pair(keys[i], int(i)));
+        own.insert(std::make_pair(keys[i], int(i)));
+        process[keys[i]] = int(i);
+    }
+    assert(fixed == own && own == process);
+    int same = 0;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        assert(fixed.at(keys[i]) == int(i) && own.at(keys[i]) == int(i) && process.at(keys[i]) == int(i));
+        same += (own.hashFunction()(keys[i]) >> 7 & 0xfff) == 0;
+    }
+    assert(same < 5);
+
+    // Copies and moves keep the seed of the map they come from.
+    cs540::HashMap<const uint64_t, int> copy(own);
+    assert(copy.hashFunction().seed == own.hashFunction().seed && copy == own);
+    process = std::move(own);
+    assert(process.hashFunction().seed == copy.hashFunction().seed && process == copy);
+}
+
+/*
+ * Random inserts and erases on few distinct keys, against std::unordered_map. The keys clump in a
+ * few groups, so most of the erased slots become deleted, and the table is cleaned up in place.
+ */
+
+void
+test_stress(int iterations) {
+
+    cs540::HashMap<const Clumped, int, ClumpedHash> map;
+    std::unordered_map<int, int> ref;
+    for (int i = 0; i < iterations; i++) {
+        int k = rand() % 300;
+        switch (rand() % 3) {
+            case 0:
+                {
+                    auto r = map.insert(std::make_pair(Clumped(k), i));
+                    assert(r.second == ref.insert(std::make_pair(k, i)).second);
+                }
+                break;
+            case 1:
+                map.erase(Clumped(k));
+                ref.erase(k);
+                break;
+            case 2:
+                {
+                    auto it = map.find(Clumped(k));
+                    auto ref_it = ref.find(k);
+                    assert((it == map.end()) == (ref_it == ref.end()));
+                    assert(it == map.end() || it->second == ref_it->second);
+                }
+                break;
+        }
+        assert(map.size() == int(ref.size()));
+    }
+    int n = 0;
+    for (auto &e : map) {
+        assert(ref.at(e.first.num) == e.second);
+        n++;
+    }
+    assert(n == int(ref.size()));
+}
+
+int
+main(int argc, char *argv[]) {
+
+    int iterations = 1000000;
+
+    {
+        int c;
+        while ((c = getopt(argc, argv, "i:")) != EOF) {
+            switch (c) {
+                case 'i':
+                    iterations = atoi(optarg);
+                    break;
+                case '?':
+                    fprintf(stderr, "Unrecog.\n");
+                    exit(1);
+            }
+        }
+    }
+
+    test_basics();
+    test_composite_keys();
+    test_hashed_keys();
+    test_seeds();
+    test_stress(iterations);
+}
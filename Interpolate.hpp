@@ -2,139 +2,852 @@
 #define INTERPOLATE_HPP
 #include<sstream>
 #include<string>
+#include<string_view>
 #include <iostream>
-#include <typeinfo>
+#include <tuple>
+#include <utility>
 #include <exception>
+#include <iomanip>
+#include <type_traits>
+#include <charconv>
+#include <locale>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace cs540 {
 using namespace std;
 struct WrongNumberOfArgs : public std::exception { };
 
-class Helper {
-	public:
-		// Assign string buffer to Ostream
-		Helper() : outputStr ( new std::ostream(&stringBuffer) ) { }
-		// Returns string buffer
-		std::stringbuf& getBuff() { return stringBuffer; }	
-		// Returns STD::OStream
-		std::ostream* getStdStream() { return outputStr; }
-		// Flush STD::STREAM
-		void flushStdStream() { 
-			stringBuffer.str(""); 
-			stringBuffer.str().clear(); 
-			outputStr->flush(); 
-			outputStr->flags(f);
-		}
-		// Free resources
-		~Helper() { delete outputStr; }
-
-		template <typename T> Helper& operator<<(const T& t) {	
-			*outputStr << t;
-			return *this;
-		}
-	private:
-		ios::fmtflags f;
-		std::ostream* outputStr = nullptr;
-		std::stringbuf stringBuffer;	
-};
-Helper helper; // Helper Object
-
 /* force the instantiation of manipulators */
-std::string ffr(ostream& (*m)(ostream&)) { 	
+std::string ffr(ostream& (*m)(ostream&)) {
 	std::stringstream out;
 	out << m;
 	return out.str();
 }
 
-// Overload std::stringstream operator and clears buffer and delete std::ostream object
-std::stringstream& operator<<(std::stringstream& stringStr, Helper& helper) {
-	//stringStr.flags (helper.getStdStream()->flags());
-	if(helper.getBuff().str() != "") {
-		stringStr << helper.getStdStream()->rdbuf();	
-	}	
-	helper.flushStdStream();	
-	return stringStr;
+/* Manipulators known from their type alone, they never take a % sign */
+template <typename T>
+constexpr bool isManipulatorType() {
+	using U = std::decay_t<T>;
+	return std::is_same_v<U, std::ostream& (*)(std::ostream&)>
+		|| std::is_same_v<U, std::ios& (*)(std::ios&)>
+		|| std::is_same_v<U, std::ios_base& (*)(std::ios_base&)>
+		|| std::is_same_v<U, decltype(std::setw(0))>
+		|| std::is_same_v<U, decltype(std::setprecision(0))>
+		|| std::is_same_v<U, decltype(std::setbase(0))>
+		|| std::is_same_v<U, decltype(std::setfill('\0'))>
+		|| std::is_same_v<U, decltype(std::setiosflags(std::ios_base::fmtflags()))>
+		|| std::is_same_v<U, decltype(std::resetiosflags(std::ios_base::fmtflags()))>;
 }
 
-// Overload std::ostream operator and clears buffer and delete std::ostream object
-std::ostream& operator<<(std::ostream& outStream, Helper& helper) { 
-	outStream << helper.getStdStream()->rdbuf();
-	helper.flushStdStream();	
-	return outStream;
+/* Argument with a name for %{name} placeholders, made by arg("name", value) */
+template <typename T>
+struct NamedArg {
+	std::string_view name;
+	const T& value;
+	friend std::ostream& operator<<(std::ostream& os, const NamedArg& a) { return os << a.value; }
+};
+
+template <typename T>
+NamedArg<T> arg(std::string_view name, const T& value) {
+	return NamedArg<T>{name, value};
 }
 
-/* Check if for % sign there is argument and Raw string manipulation (replace '\%' with '%')*/
-std::size_t isArgumentsCorrect(std::string& r_str) {	
-	std::size_t index = 0;
-	while((index = r_str.find("%", index)) != -1) {
-		if(index == 0 || r_str[index-1] != '\\') { break; }
-		r_str.replace(index-1, 2, std::string("%"));
+template <typename T>
+struct IsNamedArg : std::false_type { };
+template <typename T>
+struct IsNamedArg<NamedArg<T>> : std::true_type { };
+
+template <typename T>
+const T& unwrapNamed(const T& t) { return t; }
+template <typename T>
+const T& unwrapNamed(const NamedArg<T>& a) { return a.value; }
+
+template <typename T>
+std::string_view nameOf(const T&) { return std::string_view(); }
+template <typename T>
+std::string_view nameOf(const NamedArg<T>& a) { return a.name; }
+
+/* Check for manipulators: arguments that print nothing don't take a % sign */
+template <typename T>
+bool isManipulators(const T& t) {
+	if constexpr(isManipulatorType<T>()) {
+		return true;
+	} else if constexpr(std::is_convertible_v<const T&, std::string_view>) {
+		return std::string_view(t).empty();
+	} else {
+		return false;
 	}
-	return index;
 }
 
-/* Check for ios Base type (Manipulators) */
+/* Integers and floating point numbers, characters and bool are left to the stream */
+template <typename T>
+constexpr bool isNumber() {
+	using U = std::decay_t<T>;
+	return std::is_floating_point_v<U> || (std::is_integral_v<U> && sizeof(U) > 1 && !std::is_same_v<U, bool>
+		&& !std::is_same_v<U, wchar_t> && !std::is_same_v<U, char16_t> && !std::is_same_v<U, char32_t>);
+}
+
+/*
+ * Write a number with to_chars when it prints the same as operator<< would: no width, no showpos,
+ * showpoint or uppercase, decimal integers and classic locale. Returns false if the stream has to do it.
+ */
 template <typename T>
-bool isManipulators(T&& t) {
-	std::stringstream tempBuffer;
-	tempBuffer << t;
-	if(typeid(T) == typeid(std::ios_base& (*)(std::ios_base&)) || 
-				tempBuffer.str().empty() ) {
+bool writeNumber(std::ostream& os, bool isClassic, T t) {
+	std::ios_base::fmtflags f = os.flags();
+	if(!isClassic || os.width() != 0 || (f & (std::ios_base::showpos | std::ios_base::showpoint | std::ios_base::uppercase))) {
+		return false;
+	}
+	char buf[64];
+	std::to_chars_result r;
+	if constexpr(std::is_integral_v<T>) {
+		if((f & std::ios_base::basefield) != std::ios_base::dec && (f & std::ios_base::basefield) != 0) {
+			return false;
+		}
+		r = std::to_chars(buf, buf + sizeof buf, t);
+	} else {
+#if __cpp_lib_to_chars >= 201611L
+		int precision = int(os.precision());
+		if(precision < 0) {
+			return false;
+		}
+		std::ios_base::fmtflags floatfield = f & std::ios_base::floatfield;
+		if(floatfield == std::ios_base::fixed) {
+			r = std::to_chars(buf, buf + sizeof buf, t, std::chars_format::fixed, precision);
+		} else if(floatfield == std::ios_base::scientific) {
+			r = std::to_chars(buf, buf + sizeof buf, t, std::chars_format::scientific, precision);
+		} else if(floatfield == std::ios_base::fmtflags()) {
+			r = std::to_chars(buf, buf + sizeof buf, t, std::chars_format::general, precision);
+		} else {
+			return false;
+		}
+#else
+		return false;
+#endif
+	}
+	// Too long for the buffer, let the stream print it
+	if(r.ec != std::errc()) {
+		return false;
+	}
+	os.write(buf, r.ptr - buf);
+	return true;
+}
+
+template <typename T, typename = void>
+struct IsStreamable : std::false_type { };
+template <typename T>
+struct IsStreamable<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>())>> : std::true_type { };
+
+template <typename T, typename = void>
+struct IsRange : std::false_type { };
+template <typename T>
+struct IsRange<T, std::void_t<decltype(std::begin(std::declval<const T&>()) != std::end(std::declval<const T&>()))>> : std::true_type { };
+
+template <typename T, typename = void>
+struct IsTuple : std::false_type { };
+template <typename T>
+struct IsTuple<T, std::void_t<decltype(std::tuple_size<T>::value)>> : std::true_type { };
+
+/* Range or tuple with its separators, made by join(r, ", ", ": ") */
+template <typename T>
+struct Joined {
+	const T& value;
+	std::string_view sep;
+	std::string_view pairSep;
+};
+
+template <typename T>
+struct IsJoined : std::false_type { };
+template <typename T>
+struct IsJoined<Joined<T>> : std::true_type { };
+
+/* Ranges and tuples without an operator<< of their own are printed element by element */
+template <typename T>
+constexpr bool isComposite() {
+	using U = std::decay_t<T>;
+	if constexpr(IsJoined<U>::value) {
 		return true;
+	} else {
+		return !IsStreamable<U>::value && !std::is_convertible_v<const U&, std::string_view>
+			&& (IsRange<U>::value || IsTuple<U>::value);
 	}
-	return false;
 }
 
-/* Update ostream and raw string */
+/*
+ * Print a range or tuple given to Interpolate with sep between its elements. Elements that are
+ * tuples, like the pairs of a Map, have their fields separated by pairSep.
+ */
 template <typename T>
-void print(std::string& r_str, std::size_t index, T&& t) {
-	if(index > 0) {	helper << r_str.substr(0, index); }
-	helper << t; 
-	r_str = r_str.substr(index + 1);
+Joined<T> join(const T& t, std::string_view sep = ", ", std::string_view pairSep = ": ") {
+	static_assert(IsRange<T>::value || IsTuple<T>::value, "join() takes a range or a tuple");
+	return Joined<T>{t, sep, pairSep};
 }
 
-Helper& Interpolate(std::string r_str) { 
-	std::size_t index = 0;
-	if(r_str == "") { return helper; }
-	while((index = r_str.find("%", index)) != -1) {
-		if(index != 0 && r_str[index-1] == '\\') { 
-			r_str.replace(index-1, 2, std::string("%"));
+template <typename Out, typename T, typename Leaf>
+void writeComposite(Out& out, const T& t, std::string_view sep, std::string_view pairSep, const Leaf& leaf, bool isNested);
+
+template <typename Out, typename T, typename Leaf>
+void writeElement(Out& out, const T& t, std::string_view sep, std::string_view pairSep, const Leaf& leaf) {
+	if constexpr(isComposite<T>()) {
+		writeComposite(out, t, sep, pairSep, leaf, true);
+	} else {
+		leaf(t);
+	}
+}
+
+/*
+ * Write a range or tuple one element at a time, leaf(e) prints the elements that are neither.
+ * Nested ranges are put in [], nested tuples use pairSep.
+ */
+template <typename Out, typename T, typename Leaf>
+void writeComposite(Out& out, const T& t, std::string_view sep, std::string_view pairSep, const Leaf& leaf, bool isNested) {
+	if constexpr(IsJoined<T>::value) {
+		writeComposite(out, t.value, t.sep, t.pairSep, leaf, isNested);
+	} else if constexpr(IsRange<T>::value) {
+		if(isNested) {
+			out.write("[", 1);
+		}
+		bool isFirst = true;
+		for(const auto& e : t) {
+			if(!isFirst) {
+				out.write(sep.data(), sep.size());
+			}
+			isFirst = false;
+			writeElement(out, e, sep, pairSep, leaf);
+		}
+		if(isNested) {
+			out.write("]", 1);
+		}
+	} else {
+		std::string_view s = isNested ? pairSep : sep;
+		std::apply([&](const auto&... es) {
+			bool isFirst = true;
+			((isFirst ? void(isFirst = false) : void(out.write(s.data(), s.size())),
+				writeElement(out, es, sep, pairSep, leaf)), ...);
+		}, t);
+	}
+}
+
+/* Print one argument, numbers skip the stream if they can */
+template <typename T>
+void writeArg(std::ostream& os, bool isClassic, const T& t) {
+	if constexpr(isComposite<T>()) {
+		writeComposite(os, t, ", ", ": ", [&](const auto& e) { writeArg(os, isClassic, e); }, false);
+	} else {
+		if constexpr(isNumber<T>()) {
+			if(writeNumber(os, isClassic, t)) {
+				return;
+			}
+		}
+		os << t;
+	}
+}
+
+/* Numbers, characters and strings: operator<< leaves flags, precision and fill alone */
+template <typename T>
+constexpr bool isPlainValue() {
+	using U = std::decay_t<T>;
+	if constexpr(IsNamedArg<U>::value) {
+		return isPlainValue<decltype(std::declval<U>().value)>();
+	} else {
+		return std::is_arithmetic_v<U> || std::is_convertible_v<const T&, std::string_view>;
+	}
+}
+
+/* Only manipulators and types with their own operator<< can change the stream state */
+template <typename... Ts>
+constexpr bool changesState = !(isPlainValue<Ts>() && ...);
+
+/* Numbers look at the locale, ranges and tuples may hold numbers */
+template <typename T>
+constexpr bool mayHaveNumbers() {
+	using U = std::decay_t<decltype(unwrapNamed(std::declval<const T&>()))>;
+	return isNumber<U>() || isComposite<U>();
+}
+
+template <typename... Ts>
+constexpr bool hasNumbers = (mayHaveNumbers<Ts>() || ...);
+
+/*
+ * Saves formatting state of a stream and restores it when going out of scope. Width is set back to
+ * 0, as any formatted output leaves it, so a setw after the last argument doesn't reach the output
+ * of the caller, and one set before the call isn't applied twice. Does nothing if the arguments
+ * can't change it.
+ */
+template <bool isSaved>
+class StreamState {
+	public:
+		explicit StreamState(std::ostream& o) : os(o), flags(o.flags()), precision(o.precision()), fill(o.fill()) { }
+		~StreamState() {
+			os.flags(flags);
+			os.precision(precision);
+			os.fill(fill);
+			os.width(0);
+		}
+	private:
+		std::ostream& os;
+		std::ios_base::fmtflags flags;
+		std::streamsize precision;
+		char fill;
+};
+
+template <>
+class StreamState<false> {
+	public:
+		explicit StreamState(std::ostream&) { }
+};
+
+/* Classic locale lets numbers skip the stream, only asked for when there are numbers */
+template <typename... Ts>
+bool isClassicLocale(const std::ostream& os) {
+	if constexpr(hasNumbers<Ts...>) {
+		return os.getloc() == std::locale::classic();
+	} else {
+		return false;
+	}
+}
+
+/* Check if for % sign there is argument, plain loop so it can run at compile time */
+constexpr std::size_t countPlaceholders(std::string_view r_str) {
+	std::size_t count = 0;
+	for(std::size_t i = 0; i < r_str.size(); i++) {
+		count += r_str[i] == '%' && (i == 0 || r_str[i-1] != '\\');
+	}
+	return count;
+}
+
+/*
+ * Call onPercent(index, isEscaped) for every % in r_str, in order. With SSE2 (AVX2 if enabled)
+ * 16 (32) bytes are matched against % and \ at a time into bit masks, a % is escaped if the bit
+ * before it is a \. isVector = false does it a byte at a time.
+ */
+template <bool isVector = true, typename F>
+void scanPercents(std::string_view r_str, F&& onPercent) {
+	const char* p = r_str.data();
+	std::size_t n = r_str.size(), i = 0;
+	// Backslash just before the block
+	std::uint32_t carry = 0;
+#if defined(__AVX2__)
+	for(; isVector && i + 32 <= n; i += 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+		std::uint32_t pct = std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('%'))));
+		std::uint32_t bs = std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))));
+		std::uint32_t escaped = (bs << 1) | carry;
+		carry = bs >> 31;
+		for(; pct != 0; pct &= pct - 1) {
+			unsigned b = unsigned(__builtin_ctz(pct));
+			onPercent(i + b, ((escaped >> b) & 1) != 0);
+		}
+	}
+#endif
+#if defined(__SSE2__)
+	for(; isVector && i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+		std::uint32_t pct = std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('%'))));
+		std::uint32_t bs = std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+		std::uint32_t escaped = (bs << 1) | carry;
+		carry = bs >> 15;
+		for(; pct != 0; pct &= pct - 1) {
+			unsigned b = unsigned(__builtin_ctz(pct));
+			onPercent(i + b, ((escaped >> b) & 1) != 0);
+		}
+	}
+#endif
+	(void)carry;
+	for(; i < n; i++) {
+		if(p[i] == '%') {
+			onPercent(i, i > 0 && p[i-1] == '\\');
+		}
+	}
+}
+
+/* Piece of format text [from, to) that is written out as is */
+struct Segment {
+	std::size_t from, to;
+};
+
+/*
+ * Placeholder in a format: the segments before it end at segmentsEnd. It refers to an argument by
+ * index, or by name for %{name}. Plain % takes the next index, %1, %2... count from 1.
+ */
+struct Placeholder {
+	std::size_t segmentsEnd;
+	std::size_t index;
+	bool isNamed;
+	std::size_t nameFrom, nameLength;
+};
+
+/*
+ * The '}' that closes the name of a %{name} placeholder whose '{' is at open, npos if the name
+ * runs into whitespace, '%', '{' or the end first. Then the % is a plain placeholder and the rest
+ * is text, so a stray %{ can't take in the text and placeholders after it.
+ */
+constexpr std::size_t closeOfName(std::string_view r_str, std::size_t open) {
+	if(open >= r_str.size() || r_str[open] != '{') {
+		return std::string_view::npos;
+	}
+	for(std::size_t i = open + 1; i < r_str.size(); i++) {
+		char c = r_str[i];
+		if(c == '}') {
+			return i;
+		}
+		if(c == '%' || c == '{' || c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f') {
+			break;
+		}
+	}
+	return std::string_view::npos;
+}
+
+/* Format cut into segments, '\' of '\%' is left out, so each segment is a single write */
+struct ParsedFormat {
+	std::string text;
+	std::vector<Segment> segments;
+	std::vector<Placeholder> holders;
+};
+
+inline ParsedFormat parsePlaceholders(std::string_view r_str) {
+	ParsedFormat f;
+	f.text.assign(r_str.data(), r_str.size());
+	std::size_t from = 0, next = 0;
+	auto addSegment = [&](std::size_t to) {
+		if(to > from) {
+			f.segments.push_back(Segment{from, to});
+		}
+	};
+	scanPercents(r_str, [&](std::size_t pos, bool isEscaped) {
+		// Inside of the previous placeholder
+		if(pos < from) {
+			return;
+		}
+		if(isEscaped) {
+			addSegment(pos - 1 > from ? pos - 1 : from);
+			from = pos;
+			return;
+		}
+		addSegment(pos);
+		Placeholder h{f.segments.size(), 0, false, 0, 0};
+		std::size_t end = pos + 1;
+		std::size_t close = closeOfName(r_str, end);
+		if(end < r_str.size() && r_str[end] >= '0' && r_str[end] <= '9') {
+			std::size_t n = 0;
+			for(; end < r_str.size() && r_str[end] >= '0' && r_str[end] <= '9'; end++) {
+				n = n < 1000000 ? 10*n + (r_str[end] - '0') : n;
+			}
+			// %0 refers to nothing
+			h.index = n - 1;
+		} else if(close != std::string_view::npos) {
+			h.isNamed = true;
+			h.nameFrom = end + 1;
+			h.nameLength = close - end - 1;
+			end = close + 1;
 		} else {
-			helper.flushStdStream();
+			h.index = next++;
+		}
+		f.holders.push_back(h);
+		from = end;
+	});
+	addSegment(r_str.size());
+	return f;
+}
+
+/* Write segments [first, last) of a format to a stream or a sink */
+template <typename Out>
+void writeSegments(Out& os, const ParsedFormat& f, std::size_t first, std::size_t last) {
+	for(std::size_t i = first; i < last; i++) {
+		os.write(f.text.data() + f.segments[i].from, f.segments[i].to - f.segments[i].from);
+	}
+}
+
+/*
+ * Parsed formats of this thread, by address of the format. The text is compared on a hit, so a
+ * buffer reused for another format is parsed again. Past MAX_CACHED formats, parse into scratch.
+ */
+inline const ParsedFormat& cachedFormat(std::string_view r_str, ParsedFormat& scratch) {
+	static constexpr std::size_t MAX_CACHED = 1024;
+	thread_local std::unordered_map<const char*, ParsedFormat> cache;
+	auto it = cache.find(r_str.data());
+	if(it != cache.end()) {
+		if(it->second.text != r_str) {
+			it->second = parsePlaceholders(r_str);
+		}
+		return it->second;
+	}
+	if(cache.size() >= MAX_CACHED) {
+		scratch = parsePlaceholders(r_str);
+		return scratch;
+	}
+	return cache.emplace(r_str.data(), parsePlaceholders(r_str)).first->second;
+}
+
+/* Arguments of one call that take placeholders: their position among all arguments and their names */
+template <std::size_t N>
+struct Arguments {
+	std::size_t position[N + 1] = {};
+	std::string_view names[N + 1];
+	std::size_t count = 0;
+
+	Arguments(const bool* isManip, const std::string_view* allNames) {
+		for(std::size_t i = 0; i < N; i++) {
+			if(!isManip[i]) {
+				position[count] = i;
+				names[count++] = allNames[i];
+			}
+		}
+	}
+
+	/* Argument a placeholder refers to, npos if there is none */
+	std::size_t of(const ParsedFormat& f, const Placeholder& h) const {
+		if(!h.isNamed) {
+			return h.index < count ? h.index : std::string_view::npos;
+		}
+		std::string_view name(f.text.data() + h.nameFrom, h.nameLength);
+		for(std::size_t k = 0; k < count; k++) {
+			if(!names[k].empty() && names[k] == name) {
+				return k;
+			}
+		}
+		return std::string_view::npos;
+	}
+
+	/* Every placeholder has to refer to an argument, and every argument has to be used */
+	void check(const ParsedFormat& f) const {
+		bool isUsed[N + 1] = {};
+		std::size_t used = 0;
+		for(const Placeholder& h : f.holders) {
+			std::size_t k = of(f, h);
+			if(k == std::string_view::npos) {
+				throw WrongNumberOfArgs();
+			}
+			used += !isUsed[k];
+			isUsed[k] = true;
+		}
+		if(used != count) {
 			throw WrongNumberOfArgs();
 		}
 	}
-	return (helper << r_str); 
+
+	/* First of the arguments that come before argument k and take no placeholder */
+	std::size_t manipulatorsOf(std::size_t k) const {
+		return k == 0 ? 0 : position[k-1] + 1;
+	}
+};
+
+/* Call f with the argument at position i of a tuple */
+template <typename Tuple, typename F, std::size_t... Is>
+void visitArg(const Tuple& t, std::size_t i, F&& f, std::index_sequence<Is...>) {
+	(void)((Is == i ? (f(std::get<Is>(t)), true) : false) || ...);
+}
+
+/*
+ * Result of Interpolate(): keeps references to the format string and the arguments and formats
+ * them straight into the stream it is written to. Nothing is shared between calls, so any number
+ * of threads can interpolate at the same time. It has to be written out in the full expression
+ * that created it, the arguments are not copied.
+ */
+template <typename... Ts>
+class Interpolation {
+	public:
+		explicit Interpolation(std::string_view r_str, Ts&&... ts) : format(r_str), args(std::forward<Ts>(ts)...) { }
+
+		friend std::ostream& operator<<(std::ostream& outStream, const Interpolation& in) {
+			in.print(outStream, std::index_sequence_for<Ts...>());
+			return outStream;
+		}
+	private:
+		std::string_view format;
+		std::tuple<Ts&&...> args;
+
+		/*
+		 * Manipulators are applied right before the argument that follows them, every time it is
+		 * printed, and the ones after the last argument at the end.
+		 */
+		template <std::size_t... Is>
+		void print(std::ostream& os, std::index_sequence<Is...> seq) const {
+			bool isManip[sizeof...(Ts) + 1] = {isManipulators(std::get<Is>(args))...};
+			std::string_view names[sizeof...(Ts) + 1] = {nameOf(std::get<Is>(args))...};
+			Arguments<sizeof...(Ts)> a(isManip, names);
+			ParsedFormat scratch;
+			const ParsedFormat& f = cachedFormat(format, scratch);
+			// Check before writing anything, so nothing is printed for wrong number of arguments
+			a.check(f);
+			StreamState<changesState<Ts...>> state(os);
+			bool isClassic = isClassicLocale<Ts...>(os);
+			auto manipulate = [&](const auto& t) { writeArg(os, isClassic, unwrapNamed(t)); };
+			std::size_t seg = 0;
+			for(const Placeholder& h : f.holders) {
+				writeSegments(os, f, seg, h.segmentsEnd);
+				seg = h.segmentsEnd;
+				std::size_t k = a.of(f, h);
+				for(std::size_t i = a.manipulatorsOf(k); i < a.position[k]; i++) {
+					visitArg(args, i, manipulate, seq);
+				}
+				visitArg(args, a.position[k], [&](const auto& t) { writeArg(os, isClassic, unwrapNamed(t)); }, seq);
+			}
+			writeSegments(os, f, seg, f.segments.size());
+			for(std::size_t i = a.manipulatorsOf(a.count); i < sizeof...(Ts); i++) {
+				visitArg(args, i, manipulate, seq);
+			}
+		}
+};
+
+template <typename... Ts>
+Interpolation<Ts...> Interpolate(std::string_view r_str, Ts&&... args) {
+	return Interpolation<Ts...>(r_str, std::forward<Ts>(args)...);
+}
+
+#if __cpp_nontype_template_args >= 201911L && __cpp_concepts >= 201907L
+/* String literal usable as a template argument */
+template <std::size_t N>
+struct FixedString {
+	char str[N] = {};
+	constexpr FixedString(const char (&s)[N]) {
+		for(std::size_t i = 0; i < N; i++) { str[i] = s[i]; }
+	}
+	constexpr std::string_view view() const { return std::string_view(str, N - 1); }
+};
+
+/* Format string with '\%' unescaped, cut at the P placeholders into P + 1 segments */
+template <std::size_t N, std::size_t P>
+struct Segments {
+	char text[N] = {};
+	std::size_t cut[P + 2] = {};
+	constexpr std::string_view segment(std::size_t i) const {
+		return std::string_view(text + cut[i], cut[i+1] - cut[i]);
+	}
+};
+
+template <std::size_t P, std::size_t N>
+constexpr Segments<N, P> parseFormat(const FixedString<N>& fmt) {
+	Segments<N, P> s;
+	std::string_view r_str = fmt.view();
+	std::size_t len = 0, p = 0;
+	for(std::size_t i = 0; i < r_str.size(); i++) {
+		if(r_str[i] != '%') {
+			s.text[len++] = r_str[i];
+		} else if(i > 0 && r_str[i-1] == '\\') {
+			s.text[len-1] = '%';
+		} else {
+			s.cut[++p] = len;
+		}
+	}
+	s.cut[P+1] = len;
+	return s;
+}
+
+template <FixedString F>
+constexpr std::size_t placeholders = countPlaceholders(F.view());
+
+/* Only plain % placeholders, %1 and %{name} are left to the runtime overload */
+constexpr bool isSequential(std::string_view r_str) {
+	for(std::size_t i = 0; i + 1 < r_str.size(); i++) {
+		if(r_str[i] != '%' || (i > 0 && r_str[i-1] == '\\')) {
+			continue;
+		}
+		if(r_str[i+1] >= '0' && r_str[i+1] <= '9') {
+			return false;
+		}
+		if(closeOfName(r_str, i + 1) != std::string_view::npos) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename... Ts>
+constexpr std::size_t consumingArgs = (std::size_t(0) + ... + !isManipulatorType<Ts>());
+
+/*
+ * Result of Interpolate<"format">(): the format is split into segments at compile time, so printing
+ * only writes the segments and arguments in turn. Manipulators are told apart by type only, an empty
+ * string takes a % sign here.
+ */
+template <FixedString F, typename... Ts>
+class FormatInterpolation {
+	public:
+		explicit FormatInterpolation(Ts&&... ts) : args(std::forward<Ts>(ts)...) { }
+
+		friend std::ostream& operator<<(std::ostream& outStream, const FormatInterpolation& in) {
+			in.print(outStream, std::index_sequence_for<Ts...>());
+			return outStream;
+		}
+	private:
+		static constexpr Segments<sizeof(F.str), placeholders<F>> segments = parseFormat<placeholders<F>>(F);
+		std::tuple<Ts&&...> args;
+
+		template <std::size_t... Is>
+		void print(std::ostream& os, std::index_sequence<Is...>) const {
+			StreamState<changesState<Ts...>> state(os);
+			[[maybe_unused]] bool isClassic = isClassicLocale<Ts...>(os);
+			std::size_t seg = 0;
+			(printArg(os, isClassic, seg, std::get<Is>(args)), ...);
+			std::string_view last = segments.segment(seg);
+			os.write(last.data(), last.size());
+		}
+
+		template <typename T>
+		static void printArg(std::ostream& os, bool isClassic, std::size_t& seg, const T& t) {
+			if constexpr(isManipulatorType<T>()) {
+				os << t;
+			} else {
+				std::string_view s = segments.segment(seg++);
+				os.write(s.data(), s.size());
+				writeArg(os, isClassic, t);
+			}
+		}
+};
+
+/* Wrong number of arguments for the format is a compile error, so is %1 or %{name} */
+template <FixedString F, typename... Ts>
+	requires (isSequential(F.view()) && consumingArgs<Ts...> == placeholders<F>)
+FormatInterpolation<F, Ts...> Interpolate(Ts&&... args) {
+	return FormatInterpolation<F, Ts...>(std::forward<Ts>(args)...);
 }
+#endif
+
+/*
+ * Sinks for Interpolate_to(): anything with write(const char*, std::size_t). Numbers, characters and
+ * strings are written straight to the sink. Other types are streamed into it through SinkBuffer.
+ */
+template <typename S, typename = void>
+struct IsSink : std::false_type { };
+template <typename S>
+struct IsSink<S, std::void_t<decltype(std::declval<S&>().write((const char*)0, std::size_t()))>> : std::true_type { };
+
+#if __cpp_concepts >= 201907L
+template <typename S>
+concept InterpolateSink = IsSink<S>::value;
+#endif
 
-template <typename T, typename... Ts>
-Helper& Interpolate(std::string r_str, T&& t) {	
-	std::size_t index = 0;
-	if(isManipulators(t)) {
-		helper << t;
-		return Interpolate(r_str);
+/* Writes into a char buffer of cap bytes, keeps the last byte for '\0' and counts what did not fit */
+class BufferSink {
+	public:
+		BufferSink(char* b, std::size_t c) : buf(b), cap(c) { }
+		void write(const char* str, std::size_t n) {
+			if(len + 1 < cap) {
+				std::size_t room = cap - 1 - len;
+				std::char_traits<char>::copy(buf + len, str, n < room ? n : room);
+			}
+			len += n;
+		}
+		/* Terminate the output, returns the length it would have without truncation */
+		std::size_t finish() {
+			if(cap > 0) {
+				buf[len < cap ? len : cap - 1] = '\0';
+			}
+			return len;
+		}
+	private:
+		char* buf;
+		std::size_t cap;
+		std::size_t len = 0;
+};
+
+/* Stream buffer that hands everything to a sink, for types only operator<< knows */
+template <typename Sink>
+class SinkBuffer : public std::streambuf {
+	public:
+		explicit SinkBuffer(Sink& s) : sink(s) { }
+	protected:
+		int_type overflow(int_type c) override {
+			if(!traits_type::eq_int_type(c, traits_type::eof())) {
+				char ch = traits_type::to_char_type(c);
+				sink.write(&ch, 1);
+			}
+			return traits_type::not_eof(c);
+		}
+		std::streamsize xsputn(const char* str, std::streamsize n) override {
+			sink.write(str, std::size_t(n));
+			return n;
+		}
+	private:
+		Sink& sink;
+};
+
+/* Counts the bytes going to a sink */
+template <typename Sink>
+struct CountingSink {
+	Sink& sink;
+	std::size_t count;
+	void write(const char* str, std::size_t n) {
+		sink.write(str, n);
+		count += n;
+	}
+};
+
+#if __cpp_lib_to_chars >= 201611L
+constexpr bool hasFloatToChars = true;
+#else
+constexpr bool hasFloatToChars = false;
+#endif
+
+/* Print one argument to a sink the way a stream in its default state would */
+template <typename Sink, typename T>
+void sinkArg(Sink& sink, const T& t) {
+	using U = std::decay_t<T>;
+	if constexpr(std::is_same_v<U, bool>) {
+		sink.write(t ? "1" : "0", 1);
+	} else if constexpr(std::is_same_v<U, char>) {
+		sink.write(&t, 1);
+	} else if constexpr(isNumber<T>() && (std::is_integral_v<U> || hasFloatToChars)) {
+		char buf[64];
+		std::to_chars_result r;
+		if constexpr(std::is_integral_v<U>) {
+			r = std::to_chars(buf, buf + sizeof buf, t);
+		} else {
+			r = std::to_chars(buf, buf + sizeof buf, t, std::chars_format::general, 6);
+		}
+		sink.write(buf, std::size_t(r.ptr - buf));
+	} else if constexpr(std::is_convertible_v<const T&, std::string_view>) {
+		std::string_view str(t);
+		sink.write(str.data(), str.size());
+	} else if constexpr(isComposite<T>()) {
+		writeComposite(sink, t, ", ", ": ", [&](const auto& e) { sinkArg(sink, e); }, false);
+	} else {
+		SinkBuffer<Sink> buf(sink);
+		std::ostream os(&buf);
+		os << t;
 	}
-	if((index = isArgumentsCorrect(r_str)) == -1) {
-		helper.flushStdStream();
-		throw WrongNumberOfArgs();
-	}	
-	print(r_str, index, t);
-	return Interpolate(r_str);
 }
 
-template <typename T, typename... Ts>
-Helper& Interpolate(std::string r_str, T&& t, Ts&&... rest) {
-	std::size_t index = 0;	
-	if(isManipulators(t)) {
-		helper << t;
-		return Interpolate(r_str, rest...);
+/*
+ * Interpolate into a sink instead of a stream, same placeholder and \% rules. There is no stream state, so
+ * manipulators are rejected at compile time. Returns the number of bytes written to the sink.
+ */
+template <typename Sink, typename... Ts>
+std::enable_if_t<IsSink<Sink>::value, std::size_t> Interpolate_to(Sink& sink, std::string_view r_str, const Ts&... args) {
+	static_assert(!(isManipulatorType<Ts>() || ...), "Interpolate_to() has no stream for manipulators");
+	bool isManip[sizeof...(Ts) + 1] = {isManipulators(args)...};
+	std::string_view names[sizeof...(Ts) + 1] = {nameOf(args)...};
+	Arguments<sizeof...(Ts)> a(isManip, names);
+	ParsedFormat scratch;
+	const ParsedFormat& f = cachedFormat(r_str, scratch);
+	a.check(f);
+	auto all = std::forward_as_tuple(args...);
+	CountingSink<Sink> out{sink, 0};
+	std::size_t seg = 0;
+	for(const Placeholder& h : f.holders) {
+		writeSegments(out, f, seg, h.segmentsEnd);
+		seg = h.segmentsEnd;
+		visitArg(all, a.position[a.of(f, h)], [&](const auto& t) { sinkArg(out, unwrapNamed(t)); }, std::index_sequence_for<Ts...>());
 	}
-	if((index = isArgumentsCorrect(r_str)) == -1) {
-		helper.flushStdStream();
-		throw WrongNumberOfArgs();
-	}	
-	print(r_str, index, t);
-	return Interpolate(r_str, rest...);
+	writeSegments(out, f, seg, f.segments.size());
+	return out.count;
+}
+
+/*
+ * Interpolate into buf like snprintf(): at most cap - 1 bytes and a '\0' are written. Returns the
+ * length of the whole output, the output was truncated if that is cap or more.
+ */
+template <typename... Ts>
+std::size_t Interpolate_to(char* buf, std::size_t cap, std::string_view r_str, const Ts&... args) {
+	BufferSink sink(buf, cap);
+	Interpolate_to(sink, r_str, args...);
+	return sink.finish();
 }
 }
 #endif
@@ -0,0 +1,368 @@
+/*
+ * Benchmarks for cs540::Interpolate. Run with
+ *
+ *    -n calls
+ *    -t threads
+ *    -c
+ *
+ * -n sets the number of calls for every case (defaults to 1000000), -t the number of threads
+ * formatting lines at the same time (defaults to 4). Every case reports ns/call, heap
+ * allocations/call and output bytes/call. With -c the results are printed as CSV rows
+ *
+ *    group,case,ns_per_call,allocs_per_call,bytes_per_call
+ *
+ * for tracking them between runs.
+ */
+
+// NOTE compile with -O2 -pthread
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <new>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Interpolate.hpp"
+#include "Map.hpp"
+
+using cs540::Interpolate;
+using clk = std::chrono::steady_clock;
+
+static long n_allocs;
+static bool csv = false;
+
+void *operator new(size_t sz) {
+    __sync_add_and_fetch(&n_allocs, 1);
+    void *p = malloc(sz == 0 ? 1 : sz);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *vp) noexcept {
+    free(vp);
+}
+
+void operator delete(void *vp, size_t) noexcept {
+    free(vp);
+}
+
+/*
+ * Stream buffer that throws the output away, but counts it so the formatting can't be
+ * optimized out.
+ */
+
+class CountingBuffer : public std::streambuf {
+    public:
+        long n_bytes = 0;
+    protected:
+        int_type overflow(int_type c) override {
+            n_bytes++;
+            return c;
+        }
+        std::streamsize xsputn(const char *, std::streamsize n) override {
+            n_bytes += n;
+            return n;
+        }
+};
+
+// Sink for Interpolate_to() that writes to a stream.
+struct StreamSink {
+    std::ostream &os;
+    void write(const char *s, std::size_t n) { os.write(s, n); }
+};
+
+struct Point {
+    int x, y;
+};
+
+std::ostream &
+operator<<(std::ostream &os, const Point &p) {
+    return os << '(' << p.x << ", " << p.y << ')';
+}
+
+void
+report(const char *group, const char *name, long calls, double secs, long allocs, long bytes) {
+    if (csv) {
+        printf("%s,%s,%.1f,%.3f,%.1f\n", group, name, secs*1e9/calls, double(allocs)/calls, double(bytes)/calls);
+    } else {
+        printf("%-9s %-32s %10.1f ns/call  %7.3f allocs/call  %9.1f B/call\n",
+            group, name, secs*1e9/calls, double(allocs)/calls, double(bytes)/calls);
+    }
+}
+
+/*
+ * Call f(os, i) n times on one thread, os throws the output away. One call before the timing
+ * fills the parse cache, so only the steady state is measured.
+ */
+
+template <typename F>
+void
+bench_call(const char *group, const char *name, long n, F f) {
+
+    CountingBuffer buf;
+    std::ostream os(&buf);
+    f(os, 0);
+
+    long bytes = buf.n_bytes;
+    long allocs = n_allocs;
+    auto start = clk::now();
+    for (long i = 0; i < n; i++) {
+        f(os, i);
+    }
+    double secs = std::chrono::duration<double>(clk::now() - start).count();
+    report(group, name, n, secs, n_allocs - allocs, buf.n_bytes - bytes);
+}
+
+/*
+ * Format n lines on each of n_threads threads, every thread writing to its own stream. Reports
+ * the wall time per line over all threads.
+ */
+
+template <typename F>
+void
+bench_lines(const char *name, int n_threads, long n, F format) {
+
+    std::vector<long> n_bytes(n_threads);
+    std::vector<std::thread> threads;
+
+    long allocs = n_allocs;
+    auto start = clk::now();
+    for (int t = 0; t < n_threads; t++) {
+        threads.emplace_back([t, n, &n_bytes, format]() {
+            CountingBuffer buf;
+            std::ostream os(&buf);
+            for (long i = 0; i < n; i++) {
+                format(os, t, i);
+            }
+            n_bytes[t] = buf.n_bytes;
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    double secs = std::chrono::duration<double>(clk::now() - start).count();
+
+    long total = 0;
+    for (long b : n_bytes) {
+        total += b;
+    }
+    report("threads", name, n_threads*n, secs, n_allocs - allocs, total);
+}
+
+/*
+ * Long templates: size bytes of text with n_holders %1 placeholders spread evenly and a \% after
+ * each of them. Scans with and without vector instructions, and interpolates the template.
+ */
+
+void
+bench_template(long n, std::size_t size, int n_holders) {
+
+    std::string fmt;
+    std::size_t fill = size/n_holders > 4 ? size/n_holders - 4 : 0;
+    for (int i = 0; i < n_holders; i++) {
+        fmt += std::string(fill/2, 'a') + "%1" + std::string(fill - fill/2, 'b') + "\\%";
+    }
+    fmt.resize(size, 'c');
+
+    // About as many bytes as n calls with 64 byte templates
+    long iters = std::max(100L, long(n*64/size));
+    char name[64];
+
+    for (bool isVector : {false, true}) {
+        long n_found = 0;
+        long allocs = n_allocs;
+        auto start = clk::now();
+        for (long i = 0; i < iters; i++) {
+            auto count = [&](std::size_t, bool e) { n_found += !e; };
+            if (isVector) {
+                cs540::scanPercents<true>(fmt, count);
+            } else {
+                cs540::scanPercents<false>(fmt, count);
+            }
+        }
+        double secs = std::chrono::duration<double>(clk::now() - start).count();
+        snprintf(name, sizeof name, "%zu B %d holders %s", size, n_holders, isVector ? "vector" : "bytes");
+        // Bytes scanned, the count keeps the scan from being optimized out
+        report("scan", name, iters, secs, n_allocs - allocs, n_found == 0 ? 0 : long(size)*iters);
+    }
+    snprintf(name, sizeof name, "%zu B %d holders", size, n_holders);
+    bench_call("template", name, iters, [&fmt](std::ostream &os, long i) {
+        os << Interpolate(fmt, i);
+    });
+}
+
+int
+main(int argc, char *argv[]) {
+
+    long n = 1000000;
+    int n_threads = 4;
+
+    {
+        int c;
+        while ((c = getopt(argc, argv, "n:t:c")) != EOF) {
+            switch (c) {
+                case 'n':
+                    n = atol(optarg);
+                    break;
+                case 't':
+                    n_threads = atoi(optarg);
+                    break;
+                case 'c':
+                    csv = true;
+                    break;
+                case '?':
+                    fprintf(stderr, "Unrecog.\n");
+                    exit(1);
+            }
+        }
+    }
+
+    if (csv) {
+        printf("group,case,ns_per_call,allocs_per_call,bytes_per_call\n");
+    }
+
+    char buf[256];
+
+    // Number of arguments.
+    bench_call("args", "Interpolate() 0", n, [](std::ostream &os, long) {
+        os << Interpolate("no arguments at all\n");
+    });
+    bench_call("args", "Interpolate() 1", n, [](std::ostream &os, long i) {
+        os << Interpolate("a=%\n", i);
+    });
+    bench_call("args", "Interpolate() 4", n, [](std::ostream &os, long i) {
+        os << Interpolate("a=% b=% c=% d=%\n", i, i + 1, i + 2, i + 3);
+    });
+    bench_call("args", "Interpolate() 8", n, [](std::ostream &os, long i) {
+        os << Interpolate("a=% b=% c=% d=% e=% f=% g=% h=%\n", i, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7);
+    });
+    bench_call("args", "snprintf() 4", n, [&buf](std::ostream &os, long i) {
+        os.write(buf, snprintf(buf, sizeof buf, "a=%ld b=%ld c=%ld d=%ld\n", i, i + 1, i + 2, i + 3));
+    });
+    bench_call("args", "snprintf() 8", n, [&buf](std::ostream &os, long i) {
+        os.write(buf, snprintf(buf, sizeof buf, "a=%ld b=%ld c=%ld d=%ld e=%ld f=%ld g=%ld h=%ld\n",
+            i, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7));
+    });
+    bench_call("args", "ostream 4", n, [](std::ostream &os, long i) {
+        os << "a=" << i << " b=" << i + 1 << " c=" << i + 2 << " d=" << i + 3 << '\n';
+    });
+
+    // Types of arguments.
+    const std::string str("a string of some length");
+    bench_call("types", "Interpolate() int", n, [](std::ostream &os, long i) {
+        os << Interpolate("value=%\n", int(i));
+    });
+    bench_call("types", "Interpolate() double", n, [](std::ostream &os, long i) {
+        os << Interpolate("value=%\n", i*0.25);
+    });
+    bench_call("types", "Interpolate() const char*", n, [](std::ostream &os, long) {
+        os << Interpolate("value=%\n", "a string of some length");
+    });
+    bench_call("types", "Interpolate() std::string", n, [&str](std::ostream &os, long) {
+        os << Interpolate("value=%\n", str);
+    });
+    bench_call("types", "Interpolate() char bool", n, [](std::ostream &os, long i) {
+        os << Interpolate("value=% %\n", char('a' + i%26), i%2 == 0);
+    });
+    bench_call("types", "Interpolate() user type", n, [](std::ostream &os, long i) {
+        os << Interpolate("value=%\n", Point{int(i), int(-i)});
+    });
+    bench_call("types", "snprintf() int", n, [&buf](std::ostream &os, long i) {
+        os.write(buf, snprintf(buf, sizeof buf, "value=%d\n", int(i)));
+    });
+    bench_call("types", "snprintf() double", n, [&buf](std::ostream &os, long i) {
+        os.write(buf, snprintf(buf, sizeof buf, "value=%g\n", i*0.25));
+    });
+    bench_call("types", "snprintf() std::string", n, [&buf, &str](std::ostream &os, long) {
+        os.write(buf, snprintf(buf, sizeof buf, "value=%s\n", str.c_str()));
+    });
+    bench_call("types", "ostream double", n, [](std::ostream &os, long i) {
+        os << "value=" << i*0.25 << '\n';
+    });
+
+    // A manipulator for every argument.
+    bench_call("manip", "Interpolate()", n, [](std::ostream &os, long i) {
+        os << Interpolate("% % % %\n", std::hex, std::showbase, i, std::setw(8), std::setfill('0'), std::dec, i%1000,
+            std::fixed, std::setprecision(3), i*0.5, std::scientific, i*1e-3);
+    });
+    bench_call("manip", "snprintf()", n, [&buf](std::ostream &os, long i) {
+        os.write(buf, snprintf(buf, sizeof buf, "%#lx %08ld %.3f %.3e\n", i, i%1000, i*0.5, i*1e-3));
+    });
+    bench_call("manip", "ostream", n, [](std::ostream &os, long i) {
+        std::ios_base::fmtflags flags = os.flags();
+        std::streamsize precision = os.precision();
+        char fill = os.fill();
+        os << std::hex << std::showbase << i << ' ' << std::setw(8) << std::setfill('0') << std::dec << i%1000 << ' '
+           << std::fixed << std::setprecision(3) << i*0.5 << ' ' << std::scientific << i*1e-3 << '\n';
+        os.flags(flags);
+        os.precision(precision);
+        os.fill(fill);
+    });
+
+    // Placeholders and other entry points.
+    bench_call("forms", "Interpolate() positional", n, [](std::ostream &os, long i) {
+        os << Interpolate("b=%2 a=%1 c=%{c} a=%1\n", i, i*0.5, cs540::arg("c", "str"));
+    });
+    bench_call("forms", "Interpolate_to()", n, [&buf](std::ostream &os, long i) {
+        os.write(buf, cs540::Interpolate_to(buf, sizeof buf, "% % % % % % % %\n",
+            i, i*1000, -i, i/7, i*0.5, i/3.0, i*1e-9, 1e6/(i + 1)));
+    });
+    bench_call("forms", "snprintf()", n, [&buf](std::ostream &os, long i) {
+        os.write(buf, snprintf(buf, sizeof buf, "%ld %ld %ld %ld %g %g %g %g\n",
+            i, i*1000, -i, i/7, i*0.5, i/3.0, i*1e-9, 1e6/(i + 1)));
+    });
+#if __cpp_nontype_template_args >= 201911L && __cpp_concepts >= 201907L
+    bench_call("forms", "Interpolate<format>()", n, [](std::ostream &os, long i) {
+        os << Interpolate<"% % % % % % % %\n">(i, i*1000, -i, i/7, i*0.5, i/3.0, i*1e-9, 1e6/(i + 1));
+    });
+#endif
+
+    // Whole containers in one call against a call per element, 1000 elements per call.
+    {
+        cs540::Map<int, double> map;
+        std::vector<int> vec;
+        for (int i = 0; i < 1000; i++) {
+            map.insert({i, i*0.25});
+            vec.push_back(i*7);
+        }
+        long calls = std::max(1L, n/1000);
+        bench_call("ranges", "Interpolate() Map", calls, [&map](std::ostream &os, long) {
+            os << Interpolate("map={%}\n", map);
+        });
+        bench_call("ranges", "Interpolate() per Map element", calls, [&map](std::ostream &os, long) {
+            os << "map={";
+            for (const auto &p : map) {
+                os << Interpolate("%: %, ", p.first, p.second);
+            }
+            os << "}\n";
+        });
+        bench_call("ranges", "Interpolate() join vector", calls, [&vec](std::ostream &os, long) {
+            os << Interpolate("%\n", cs540::join(vec, " "));
+        });
+        bench_call("ranges", "Interpolate_to() Map", calls, [&map](std::ostream &os, long) {
+            StreamSink sink{os};
+            cs540::Interpolate_to(sink, "map={%}\n", map);
+        });
+    }
+
+    // Template sizes.
+    for (std::size_t size : {64, 4096, 65536}) {
+        for (int n_holders : {10, 100, 1000}) {
+            if (std::size_t(n_holders)*4 <= size) {
+                bench_template(n, size, n_holders);
+            }
+        }
+    }
+
+    // Threads formatting at the same time.
+    bench_lines("Interpolate()", n_threads, n/n_threads, [](std::ostream &os, int t, long i) {
+        os << Interpolate("thread=%, line=%, value=%, hex=%\n", t, i, i*0.5, std::hex, i);
+    });
+}
@@ -1,4 +1,6 @@
+// NOTE compile with -pthread
 #include "Interpolate.hpp"
+#include "Map.hpp"
 #include <iostream>
 #include <typeinfo>
 #include <locale>
@@ -8,6 +10,11 @@
 #include <cassert>
 #include <ctime>
 #include <cstring>
+#include <thread>
+#include <limits>
+#include <atomic>
+#include <vector>
+#include <list>
 // Needed by {set,get}rlimit().
 #include <sys/resource.h>
 #include <sys/time.h>
@@ -37,6 +44,13 @@ class B {
     const std::string str;
 };
 
+// This class changes the stream state when printed.
+class Hex {
+    friend std::ostream &operator<<(std::ostream &os, const Hex &) {
+        return os << std::hex << std::setfill('*') << 255;
+    }
+};
+
 // This class is used to test space efficiency.
 class Out {
    public:
@@ -64,6 +78,12 @@ void test(const char *func, int line_no, const std::string &cmp, const std::stri
 }
 #define CS540_TEST(...) test(__FUNCTION__, __LINE__, __VA_ARGS__)
 
+#if __cpp_nontype_template_args >= 201911L && __cpp_concepts >= 201907L
+// True if Interpolate<F>() accepts the argument types.
+template <cs540::FixedString F, typename... Ts>
+constexpr bool compiles = requires (Ts... ts) { cs540::Interpolate<F>(ts...); };
+#endif
+
 int
 main(int argc, char **argv) {
 
@@ -270,6 +290,243 @@ main(int argc, char **argv) {
         assert(ss.str() == "11 0xabc 0xaa 123 0567");
     }
 */
+    // Test that manipulators only apply inside of the call.
+    {
+        std::stringstream s;
+        s << Interpolate("%, %", std::hex, std::showbase, 255, std::setprecision(2), 1.2345) << " " << 255 << " " << 1.2345;
+        assert(s.str() == "0xff, 1.2 255 1.2345");
+    }
+
+    // Test that state set by manipulators after the last argument, or by an operator<<, doesn't leak.
+    {
+        std::stringstream s;
+        s << Interpolate("% %", 1, Hex()) << " " << std::setw(3) << 255;
+        s << Interpolate(" %", 1, std::hex, std::setprecision(1)) << " " << 255 << " " << 1.25;
+        assert(s.str() == "1 ff 255 1 255 1.25");
+
+        std::stringstream w;
+        w << Interpolate("a=%", 1, std::setw(8));
+        w << 5;
+        w << Interpolate(" %", std::setw(3), 2, std::setw(4)) << 6;
+        assert(w.str() == "a=15   26");
+    }
+
+    // Test that state set before the call is used, and kept, when there are no manipulators.
+    {
+        std::stringstream s;
+        s << std::hex << std::showbase << std::setprecision(2);
+        s << Interpolate("% % % %", 255, 1.2345, "str", 'c') << " " << 255;
+        s << Interpolate(" %", std::dec, 255) << " " << 255;
+        assert(s.str() == "0xff 1.2 str c 0xff 255 0xff");
+    }
+
+    // Test that nothing is written when the number of args is wrong.
+    {
+        std::stringstream s;
+        try {
+            s << Interpolate("i=%, j=%", 1, 2, 3);
+            assert(false);
+        } catch (cs540::WrongNumberOfArgs &) {
+        }
+        assert(s.str().empty());
+    }
+
+    // Test many threads interpolating at the same time.
+    {
+        std::atomic<int> n_failed{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; t++) {
+            threads.emplace_back([t, &n_failed]() {
+                for (int i = 0; i < 2000; i++) {
+                    std::stringstream s, cmp;
+                    s << Interpolate(R"(thread=%, i=%, \%%)", t, std::hex, i, 'x');
+                    cmp << "thread=" << t << ", i=" << std::hex << i << ", %x";
+                    if (s.str() != cmp.str()) {
+                        n_failed++;
+                    }
+                }
+            });
+        }
+        for (auto &th : threads) {
+            th.join();
+        }
+        assert(n_failed == 0);
+    }
+
+    // Test that empty strings don't consume a % sign, but other strings do.
+    CS540_TEST("a1b", "a%b", std::string(), "", 1, std::string_view());
+    CS540_TEST("a b", "a%b", " ");
+
+    // Test that numbers print the same as with the stream, for all kinds of stream state.
+    {
+        const double doubles[] = {0.0, -0.0, 0.1, 1.0/3, -2.5, 1e300, -1e-300, 4.9e-324, 123456789.0,
+            std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN()};
+        const long longs[] = {0, 1, -1, 255, std::numeric_limits<long>::max(), std::numeric_limits<long>::min()};
+        const std::ios_base::fmtflags flags[] = {std::ios_base::dec, std::ios_base::hex, std::ios_base::oct,
+            std::ios_base::fixed, std::ios_base::scientific, std::ios_base::fixed | std::ios_base::scientific,
+            std::ios_base::showpos, std::ios_base::showpoint, std::ios_base::uppercase | std::ios_base::scientific,
+            std::ios_base::fmtflags(0)};
+        for (auto f : flags) {
+            for (int precision : {0, 1, 6, 17, 80}) {
+                for (int width : {0, 12}) {
+                    std::stringstream s, cmp;
+                    s.flags(f);
+                    cmp.flags(f);
+                    s.precision(precision);
+                    cmp.precision(precision);
+                    for (double d : doubles) {
+                        cmp << std::setw(width) << d << ' ' << std::setw(width) << float(d) << ' ';
+                        s << Interpolate("% % ", std::setw(width), d, std::setw(width), float(d));
+                    }
+                    for (long l : longs) {
+                        cmp << std::setw(width) << l << ' ' << short(l) << ' ' << (unsigned long long) l << ' ';
+                        s << Interpolate("% % % ", std::setw(width), l, short(l), (unsigned long long) l);
+                    }
+                    cmp << true << ' ' << 'c' << ' ' << (unsigned char) 'u';
+                    s << Interpolate("% % %", true, 'c', (unsigned char) 'u');
+                    assert(s.str() == cmp.str());
+                }
+            }
+        }
+    }
+
+    // Test interpolating into a buffer.
+    {
+        char buf[32];
+        std::size_t n = cs540::Interpolate_to(buf, sizeof buf, R"(i=%, x=%, s=% \%%)", -12, 0.1, std::string("foo"), true);
+        assert(n == 22 && std::string(buf) == "i=-12, x=0.1, s=foo %1");
+        std::stringstream s;
+        s << Interpolate("%,%,%,%,%,%", 1e300, 1.0/3, 'c', "str", A(1234), 2u);
+        n = cs540::Interpolate_to(buf, sizeof buf, "%,%,%,%,%,%", 1e300, 1.0/3, 'c', "str", A(1234), 2u);
+        assert(n == s.str().size() && buf == s.str());
+
+        // Truncated output is terminated, the length without truncation is returned.
+        n = cs540::Interpolate_to(buf, 8, "%:%", 123456, 789);
+        assert(n == 10 && std::string(buf) == "123456:");
+        n = cs540::Interpolate_to(buf, 0, "%", 1);
+        assert(n == 1);
+        try {
+            cs540::Interpolate_to(buf, sizeof buf, "%", 1, 2);
+            assert(false);
+        } catch (cs540::WrongNumberOfArgs &) {
+        }
+    }
+
+    // Test interpolating into a user sink.
+    {
+        struct Sink {
+            std::string str;
+            void write(const char *s, std::size_t n) { str.append(s, n); }
+        } sink;
+        std::size_t n = cs540::Interpolate_to(sink, "a%bc", 1, std::string());
+        n += cs540::Interpolate_to(sink, "%", std::string(100, 'x'));
+        assert(n == 104 && sink.str == "a1bc" + std::string(100, 'x'));
+    }
+
+    // Test positional and named placeholders.
+    CS540_TEST("2-1", "%2-%1", 1, 2);
+    // Plain % counts on its own, it doesn't continue after %1.
+    CS540_TEST("xx, x x 1", "%1%1, % %1 %", "x", 1);
+    CS540_TEST("B 1 B", "%{b} %{a} %{b}", cs540::arg("a", 1), cs540::arg("b", "B"));
+    CS540_TEST("1 2 1", "% %{two} %1", 1, cs540::arg("two", 2));
+    CS540_TEST(R"(%1 %{a} {x} a})", R"(\%1 \%{a} %} %)", "{x", "a}");
+    // A %{ without a name closed before whitespace or % is a plain % and text.
+    CS540_TEST("1{a 1 }", "%{a %1 }", 1);
+    CS540_TEST("x{a b} y{cz}", "%{a b} %{c%}", "x", "y", "z");
+    CS540_TEST("1{ 2", "%{ %{two}", 1, cs540::arg("two", 2));
+    // Manipulators go with the argument after them.
+    CS540_TEST("   7 ff", "%2 %1", std::hex, 255, std::setw(4), 7);
+    {
+        const char *bad[] = {"%1", "%3", "%0", "%{c}", "%{}", "%2 %2"};
+        for (const char *fmt : bad) {
+            std::stringstream s;
+            try {
+                s << Interpolate(fmt, 1, cs540::arg("b", 2));
+                assert(false);
+            } catch (cs540::WrongNumberOfArgs &) {
+            }
+            assert(s.str().empty());
+        }
+    }
+    // Test that the vector scan finds the same % signs as a byte at a time, across block edges.
+    {
+        const char chars[] = {'%', '\\', 'a'};
+        for (int len = 0; len < 200; len++) {
+            for (int trial = 0; trial < 20; trial++) {
+                std::string str;
+                for (int i = 0; i < len; i++) {
+                    str += chars[rand()%3];
+                }
+                std::vector<std::pair<std::size_t, bool>> vec, scalar;
+                cs540::scanPercents(str, [&](std::size_t i, bool e) { vec.emplace_back(i, e); });
+                cs540::scanPercents<false>(str, [&](std::size_t i, bool e) { scalar.emplace_back(i, e); });
+                assert(vec == scalar);
+            }
+        }
+    }
+    // Test a long format with escapes and placeholders on every offset.
+    {
+        std::string fmt, cmp;
+        for (int i = 0; i < 100; i++) {
+            fmt += std::string(i%7, 'a') + "\\%" + std::string(i%5, 'b') + "%1";
+            cmp += std::string(i%7, 'a') + "%" + std::string(i%5, 'b') + "x";
+        }
+        CS540_TEST(cmp, fmt, 'x');
+    }
+
+    // Test that a buffer reused for another format is not mistaken for the cached one.
+    {
+        char fmt[16];
+        std::stringstream s;
+        strcpy(fmt, "%1 %2,");
+        s << Interpolate(fmt, 1, 2);
+        strcpy(fmt, "%2 %1");
+        s << Interpolate(fmt, 1, 2);
+        assert(s.str() == "1 2,2 1");
+    }
+    {
+        char buf[32];
+        cs540::Interpolate_to(buf, sizeof buf, "%{y}/%2/%1", 1.5, cs540::arg("y", "why"));
+        assert(std::string(buf) == "why/why/1.5");
+    }
+
+    // Test ranges, tuples and Map contents, nested ones and their separators.
+    {
+        std::vector<int> vec{1, 2, 3};
+        std::list<std::string> empty;
+        cs540::Map<std::string, std::vector<double>> map{{"b", {0.5}}, {"a", {1, 2}}};
+        CS540_TEST("[1, 2, 3] []", "[%] [%]", vec, empty);
+        CS540_TEST("1|2|3", "%", cs540::join(vec, "|"));
+        CS540_TEST("a: [1, 2], b: [0.5]", "%", map);
+        CS540_TEST("a=[1; 2]; b=[0.5]", "%", cs540::join(map, "; ", "="));
+        CS540_TEST("1, x, 2.5, [1, 2, 3]", "%", std::make_tuple(1, "x", 2.5, vec));
+        CS540_TEST("  1, ff", "%", std::setw(3), std::hex, cs540::join(std::make_pair(1, 255)));
+
+        char buf[64];
+        std::size_t n = cs540::Interpolate_to(buf, sizeof buf, "% %", map, cs540::join(vec, ""));
+        assert(n == 23 && std::string(buf) == "a: [1, 2], b: [0.5] 123");
+    }
+
+#if __cpp_nontype_template_args >= 201911L && __cpp_concepts >= 201907L
+    // Test format strings parsed at compile time.
+    {
+        std::stringstream s;
+        s << Interpolate<R"(i=%, x=% \%%)">(1, std::setprecision(3), 3.14159, std::hex, 255) << " " << 255;
+        s << Interpolate<"">() << Interpolate<"%">(std::setw(4), std::setfill('-'), 'a');
+        assert(s.str() == "i=1, x=3.14 %ff 255---a");
+
+        // Wrong number of arguments does not compile.
+        static_assert(!compiles<"i=%, j=%", int>);
+        static_assert(!compiles<"i=%", int, int>);
+        static_assert(!compiles<R"(\%)", int>);
+        static_assert(!compiles<"%1", int>);
+        static_assert(!compiles<"%{a}", int>);
+        static_assert(compiles<"%{a", int>);
+        static_assert(compiles<"%{a b}", int>);
+        static_assert(compiles<"i=%", decltype(&std::hex), int, decltype(std::setw(0))>);
+    }
+#endif
+
     // Test space efficiency.
     {
         std::fstream out("/dev/null");
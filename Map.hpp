@@ -7,6 +7,12 @@
 #include<iostream>
 #include <stdexcept>
 #include <initializer_list>
+#include <functional>
+#include <type_traits>
+#include <stdint.h>
+#if __cpp_impl_three_way_comparison >= 201907L
+#include <compare>
+#endif
 
 namespace cs540 {
 
@@ -15,18 +21,26 @@ namespace cs540 {
 #define DEFAULT_LEVEL 1
 #define DEFAULT_HEIGHT 0
 #define CACHE_SIZE 10
+#define UNKNOWN_SIZE -1
 
 template <class Key_T, class Mapped_T> class Map;
 template <class Key_T, class Mapped_T> bool operator==(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
 template <class Key_T, class Mapped_T>  bool operator!=(const Map<Key_T, Mapped_T> & , const Map<Key_T, Mapped_T> &);
 template <class Key_T, class Mapped_T>  bool operator<(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
+template <class Key_T, class Mapped_T> int compareMaps(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
+template <class Key_T, class Mapped_T> Map<Key_T, Mapped_T> set_union(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
+template <class Key_T, class Mapped_T> Map<Key_T, Mapped_T> set_intersection(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
+template <class Key_T, class Mapped_T> Map<Key_T, Mapped_T> set_difference(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
 
 /* -------------------------- Node Structure -------------------------- */
 template <class Key_T, class Mapped_T> 
 struct Node {
 	struct Node *next, *prev, *up, *down;
-	std::pair<Key_T, Mapped_T> p;
-	Node(std::pair<Key_T, Mapped_T> _p) : next(NULL), prev(NULL), up(NULL), down(NULL), p(_p) { }
+	union { std::pair<Key_T, Mapped_T> p; }; // Not constructed for head and tail nodes
+	bool isSentinel;
+	Node() : next(NULL), prev(NULL), up(NULL), down(NULL), isSentinel(true) { }
+	Node(std::pair<Key_T, Mapped_T> _p) : next(NULL), prev(NULL), up(NULL), down(NULL), p(_p), isSentinel(false) { }
+	~Node() { if(!isSentinel) p.~pair(); }
 };
 
 /*-------------------------- Cache ---------------------------------*/
@@ -39,21 +53,42 @@ struct Cache {
 /* -------------------------- Skiplist Class -------------------------- */
 template <class Key_T, class Mapped_T> 
 class Skiplist {
-	int height, size;
+	int height = DEFAULT_HEIGHT;
+	mutable int size = DEFAULT_HEIGHT; // UNKNOWN_SIZE after split() until counted again
+	std::size_t (*hashKey)(const Key_T &) = NULL; // Set by Map::enableContentHash()
+	std::size_t keysHash = 0; // Order independent sum of hashKey() of all keys
 	Node<Key_T, Mapped_T>* head = NULL;
 	Node<Key_T, Mapped_T>* tail = NULL;		
+	Skiplist() { initialize(&head, &tail, DEFAULT_LEVEL, DEFAULT_HEIGHT); }
 	int getLevel();
-	void initialize(std::pair<const Key_T, Mapped_T>, Node<Key_T, Mapped_T>**, Node<Key_T, Mapped_T>**, int, int);
+	void initialize(Node<Key_T, Mapped_T>**, Node<Key_T, Mapped_T>**, int, int);
 	void setUPDownLink(Node<Key_T, Mapped_T>**, Node<Key_T, Mapped_T>**);
 	void setNextPrevLink(Node<Key_T, Mapped_T>**, Node<Key_T, Mapped_T>**);
-	void freeNode(Node<Key_T, Mapped_T>**, Node<Key_T, Mapped_T>**);
 	Node<Key_T, Mapped_T>* searchKey(const Key_T) const;
 	Node<Key_T, Mapped_T>* insertPair(std::pair<const Key_T, Mapped_T>);
 	void removeKey(Key_T);
+	// Tower level operations: a tower is a bottom level node and the nodes stacked on it through "up"
+	void addLevel();
+	void trimLevels();
+	Node<Key_T, Mapped_T>* bottomHead() const;
+	Node<Key_T, Mapped_T>* findPredecessor(const Key_T &) const;
+	Node<Key_T, Mapped_T>* searchFrom(Node<Key_T, Mapped_T>*, const Key_T &) const;
+	Node<Key_T, Mapped_T>* fingerSearch(Node<Key_T, Mapped_T>*, const Key_T &) const;
+	Node<Key_T, Mapped_T>* makeTower(const std::pair<const Key_T, Mapped_T> &, int);
+	void linkTower(Node<Key_T, Mapped_T>*, Node<Key_T, Mapped_T>*);
+	void unlinkTower(Node<Key_T, Mapped_T>*);
+	void deleteTower(Node<Key_T, Mapped_T>*);
+	void countSize() const;
+	void rehashKeys();
+	template <class Hash> static std::size_t mixedHash(const Key_T &);
+	Node<Key_T, Mapped_T>* insertAfter(const std::pair<const Key_T, Mapped_T> &, Node<Key_T, Mapped_T>*);
 	friend class Map<Key_T, Mapped_T>;
 	friend bool operator== <>(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
 	friend bool operator!= <>(const Map<Key_T, Mapped_T> & , const Map<Key_T, Mapped_T> &);
 	friend bool operator< <>(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
+	friend Map<Key_T, Mapped_T> set_union <>(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
+	friend Map<Key_T, Mapped_T> set_intersection <>(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
+	friend Map<Key_T, Mapped_T> set_difference <>(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
 };
 
 
@@ -71,6 +106,7 @@ class Map {
 		void insertCache(Node<Key_T, Mapped_T>*);
 		void removeCache(Key_T);
 		void clearCache();
+		void freeCache();
 	public:	
 		/* ----------------------- Iterator Class ---------------------- */
 		class Iterator {
@@ -138,15 +174,71 @@ class Map {
 			ValueType * operator->() const { return &(current->p); }
 			friend class Map<Key_T, Mapped_T>;
 		};	
+		/* -------------------------- Node Handle Class -------------------------- */
+		// Owns a tower unlinked by extract() until it is inserted into a map again
+		class NodeHandle {
+			Node<Key_T, Mapped_T>* node = NULL; // Bottom node of the tower
+			void freeTower() { 
+				while(node != NULL) {
+					Node<Key_T, Mapped_T>* upNode = node->up;
+					delete(node);
+					node = upNode;
+				}
+			}
+			public:
+			NodeHandle() { }
+			NodeHandle(NodeHandle && obj) : node(obj.node) { obj.node = NULL; }
+			NodeHandle & operator=(NodeHandle && obj) {
+				if(this != &obj) {
+					freeTower();
+					node = obj.node;
+					obj.node = NULL;
+				}
+				return *this;
+			}
+			NodeHandle(const NodeHandle &) = delete;
+			NodeHandle & operator=(const NodeHandle &) = delete;
+			~NodeHandle() { freeTower(); }
+			bool empty() const { return node == NULL; }
+			explicit operator bool() const { return node != NULL; }
+			// Every node of the tower keeps a copy of the key, so it can't be changed here
+			const Key_T & key() const { return node->p.first; }
+			Mapped_T & mapped() const { return node->p.second; }
+			friend class Map<Key_T, Mapped_T>;
+		};
+		struct InsertReturnType {
+			Iterator position;
+			bool inserted;
+			NodeHandle node;
+		};
 	public:
 		Map() { }
 		Map(const Map<Key_T, Mapped_T> &);
+		Map(Map<Key_T, Mapped_T> &&);
 		Map& operator= (const Map<Key_T, Mapped_T> &);
+		Map& operator= (Map<Key_T, Mapped_T> &&);
 		Map(std::initializer_list<std::pair<const Key_T, Mapped_T>>);
-		~Map() { clear(); }
+		~Map() { 
+			clear(); 
+			delete(skiplist.head); 
+			delete(skiplist.tail); 
+		}
 		
-		int size() const { return skiplist.size; }
-		bool empty() const { return (skiplist.size == DEFAULT_HEIGHT); }
+		int size() const { 
+			if(skiplist.size == UNKNOWN_SIZE) skiplist.countSize(); 
+			return skiplist.size; 
+		}
+		// Empty top levels are always trimmed, so only an empty map has an empty top level
+		bool empty() const { return (skiplist.head->next == skiplist.tail); }
+		// Keep a hash of the key set up to date on every insert and erase, so that == can reject 
+		// maps with different keys in O(1). Mapped values can change through references, so they 
+		// are not part of the hash.
+		template <class Hash = std::hash<typename std::remove_const<Key_T>::type>> 
+		void enableContentHash() { 
+			skiplist.hashKey = &Skiplist<Key_T, Mapped_T>::template mixedHash<Hash>; 
+			skiplist.rehashKeys(); 
+		}
+		std::size_t contentHash() const { return skiplist.keysHash; }
 		Iterator begin() { 
 			Iterator it; 
 			it.current = findFirstNode(); 
@@ -182,7 +274,7 @@ class Map {
 			it.current = retrieveCache(key); // Look up in cache
 			if(it.current == NULL) {
 				it.current = skiplist.searchKey(key);
-				if (it.current->next != NULL)
+				if (it.current != NULL && it.current->next != NULL)
 					insertCache(it.current); // insert in cache
 			} 
 			return it; 
@@ -216,8 +308,34 @@ class Map {
 			}
 			return temp->p.second; 
 		}
+		// Search starts at hint and only climbs as high as the distance to key needs, 
+		// so keys near hint are found in O(lg(d)) where d is the distance from hint
+		Iterator find_from(Iterator hint, const Key_T & key) {
+			Iterator it;
+			it.current = skiplist.fingerSearch(hint.current, key)->next;
+			if(it.current->next == NULL || !(it.current->p.first == key)) it.current = findLastNode();
+			return it;
+		}
+		ConstIterator find_from(ConstIterator hint, const Key_T & key) const {
+			ConstIterator it;
+			it.current = skiplist.fingerSearch(hint.current, key)->next;
+			if(it.current->next == NULL || !(it.current->p.first == key)) it.current = findLastNode();
+			return it;
+		}
+		// First entry whose key is not less than key, end() if there is none
+		Iterator lower_bound(const Key_T & key) {
+			Iterator it;
+			it.current = skiplist.findPredecessor(key)->next;
+			return it;
+		}
+		ConstIterator lower_bound(const Key_T & key) const {
+			ConstIterator it;
+			it.current = skiplist.findPredecessor(key)->next;
+			return it;
+		}
 		Mapped_T &operator[](const Key_T &);  
 		std::pair<Iterator, bool> insert(const ValueType &);
+		Iterator insert(Iterator, const ValueType &);
 		void erase(const Key_T & key) { 	
 			removeCache(key); // Remove node from cache
 			skiplist.removeKey(key); 
@@ -226,13 +344,28 @@ class Map {
 			removeCache(pos.current->p.first); // Remove node from cache
 			skiplist.removeKey(pos.current->p.first); 
 		}
+		NodeHandle extract(const Key_T & key) { 
+			Iterator it;
+			it.current = skiplist.searchKey(key);
+			return extract(it);
+		}
+		NodeHandle extract(Iterator);
+		InsertReturnType insert(NodeHandle &&);
 		void clear();
+		void merge(Map<Key_T, Mapped_T> &);
+		void merge(Map<Key_T, Mapped_T> && obj) { merge(obj); }
+		Map split(const Key_T &);
+		void join(Map<Key_T, Mapped_T> &);
+		void join(Map<Key_T, Mapped_T> && obj) { join(obj); }
 		
 		/* ------------------------ Operator Overloading (Friend function)---------------------------  */
 		
 		friend bool operator== <>(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
 		friend bool operator!= <>(const Map<Key_T, Mapped_T> & , const Map<Key_T, Mapped_T> &);
 		friend bool operator< <>(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
+		friend Map<Key_T, Mapped_T> set_union <>(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
+		friend Map<Key_T, Mapped_T> set_intersection <>(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
+		friend Map<Key_T, Mapped_T> set_difference <>(const Map<Key_T, Mapped_T> &, const Map<Key_T, Mapped_T> &);
 	
 		friend bool operator==(const Iterator & it1, const Iterator & it2) {  return it1.current == it2.current; }
 		friend bool operator==(const ConstIterator & it1, const ConstIterator & it2) { return it1.current == it2.current; }
@@ -242,7 +375,7 @@ class Map {
 		friend bool operator!=(const ConstIterator & it1, const ConstIterator & it2){ return it1.current != it2.current; }
 		friend bool operator!=(const Iterator & it1, const ConstIterator & it2) { return it1.current != it2.current; }
 		friend bool operator!=(const ConstIterator & it1, const Iterator & it2) { return it1.current != it2.current; }	
-		friend bool operator==(const ReverseIterator & it1, const ReverseIterator & it2) { return it1.current != it2.current; }
+		friend bool operator==(const ReverseIterator & it1, const ReverseIterator & it2) { return it1.current == it2.current; }
 		friend bool operator!=(const ReverseIterator & it1, const ReverseIterator & it2) { return it1.current != it2.current; }
 };
 
@@ -251,18 +384,17 @@ class Map {
 template <class Key_T, class Mapped_T> 
 int Skiplist<Key_T, Mapped_T>  :: getLevel() {
 	int level = DEFAULT_LEVEL;
-   	srand(time(NULL));
    	for(;level <= height && level < MAX_LEVEL && drand48() < PROBABILITY; level++);
     	return level;
 }
 
 /* Initialize Head, Tail and height and size of skip list */
 template <class Key_T, class Mapped_T> 
-void Skiplist<Key_T, Mapped_T> :: initialize( std::pair<const Key_T, Mapped_T> p, Node<Key_T, Mapped_T>** h_node, 
+void Skiplist<Key_T, Mapped_T> :: initialize(Node<Key_T, Mapped_T>** h_node, 
 					Node<Key_T, Mapped_T>** t_node, int lvl, int count) {	
 	if(*h_node != NULL) return;
-	 *h_node = new Node<Key_T, Mapped_T>(p);
-	 *t_node = new Node<Key_T, Mapped_T>(p);
+	 *h_node = new Node<Key_T, Mapped_T>();
+	 *t_node = new Node<Key_T, Mapped_T>();
 	 (*h_node)->next = *t_node;
 	 (*t_node)->prev = *h_node;
 	 height = lvl;
@@ -288,125 +420,197 @@ void Skiplist<Key_T, Mapped_T> :: setNextPrevLink(Node<Key_T, Mapped_T>** prev_n
 	(*prev_node)->next = *new_node;
 }
 
-/* Delete node from the skiplist */
+/* Search node, returns tail of the bottom level if key is not found */
+template < class Key_T, class Mapped_T > 
+Node<Key_T, Mapped_T>* Skiplist<Key_T, Mapped_T> :: searchKey(const Key_T key) const {
+	Node<Key_T, Mapped_T>* temp = findPredecessor(key)->next;
+	if(temp->next != NULL && temp->p.first == key) return temp;
+	for(temp = tail; temp->down != NULL; temp = temp->down);
+	return temp;
+}
+
+/* Insert node */
+template <class Key_T, class Mapped_T> 
+Node<Key_T, Mapped_T>* Skiplist<Key_T, Mapped_T> :: insertPair(std::pair<const Key_T, Mapped_T> p) {
+	return insertAfter(p, findPredecessor(p.first));
+}
+
+/* Remove node */
+template <class Key_T, class Mapped_T> 
+void Skiplist<Key_T, Mapped_T> :: removeKey(Key_T key) {
+	if(head == NULL) return;
+	Node<Key_T, Mapped_T>* temp = findPredecessor(key)->next;
+	if(temp->next == NULL || !(temp->p.first == key)) return;
+	unlinkTower(temp);
+	deleteTower(temp);
+	trimLevels(); // Free empty top levels
+}
+
+/* Add an empty level on top of the skiplist */
+template <class Key_T, class Mapped_T> 
+void Skiplist<Key_T, Mapped_T> :: addLevel() {
+	Node<Key_T, Mapped_T>* tempHead = new Node<Key_T, Mapped_T>();
+	Node<Key_T, Mapped_T>* tempTail = new Node<Key_T, Mapped_T>();
+	tempHead->next = tempTail;
+	tempTail->prev = tempHead;
+	setUPDownLink(&tempHead, &head);
+	setUPDownLink(&tempTail, &tail);
+	head = tempHead;
+	tail = tempTail;
+	height++;
+}
+
+/* Free empty top levels and move head and tail down, the bottom level is always kept */
 template <class Key_T, class Mapped_T> 
-void Skiplist<Key_T, Mapped_T> :: freeNode(Node<Key_T, Mapped_T>** prev_temp, 
-					Node<Key_T, Mapped_T>** temp) {
-	(*prev_temp)->next = (*temp)->next;
-	(*temp)->next->prev = *prev_temp;
-	delete(*temp);
-	if(head->next != tail) return;
-	// Free top level and move head and tail one level down
-	if(height > 1) {
+void Skiplist<Key_T, Mapped_T> :: trimLevels() {
+	while(height > DEFAULT_LEVEL && head->next == tail) {
 		head = head->down;
 		tail = tail->down;
 		delete(head->up);
 		delete(tail->up);
-		height--;	
-	} 
+		head->up = NULL;
+		tail->up = NULL;
+		height--;
+	}
 }
 
-/* Search node */
-template < class Key_T, class Mapped_T > 
-Node<Key_T, Mapped_T>* Skiplist<Key_T, Mapped_T> :: searchKey(const Key_T key) const {
-	bool isFound = false;
-	Node<Key_T, Mapped_T>* tempHead = head;	
-	Node<Key_T, Mapped_T>* tempTail = tail;	
-	
-	for(; tempHead != NULL; tempHead = tempHead->down) {	
-		Node<Key_T, Mapped_T>* temp = tempHead;
-		for(; temp != tempTail; temp = temp->next) {
-			if(temp->prev != NULL && temp->p.first == key) {
-				tempHead = temp;
-				isFound = true;
-				break;
-			}
-			else if(temp->prev != NULL && !(temp->p.first < key) && !(temp->p.first == key)) {
-				tempHead = temp->prev;
-				break;
-			}
+/* Find head of the bottom level */
+template <class Key_T, class Mapped_T> 
+Node<Key_T, Mapped_T>* Skiplist<Key_T, Mapped_T> :: bottomHead() const {
+	Node<Key_T, Mapped_T>* tempHead = head;
+	for( ; tempHead->down != NULL; tempHead = tempHead->down);
+	return tempHead;
+}
+
+/* Find last bottom level node whose key is less than key (head of the bottom level if none) */
+template <class Key_T, class Mapped_T> 
+Node<Key_T, Mapped_T>* Skiplist<Key_T, Mapped_T> :: findPredecessor(const Key_T & key) const {
+	return searchFrom(head, key);
+}
+
+/* Walk right while next key is less than key then move down, starting at temp whose key is less than key */
+template <class Key_T, class Mapped_T> 
+Node<Key_T, Mapped_T>* Skiplist<Key_T, Mapped_T> :: searchFrom(Node<Key_T, Mapped_T>* temp, const Key_T & key) const {
+	while(true) {
+		while(temp->next->next != NULL && temp->next->p.first < key) {
+			temp = temp->next;
 		}
-		if(tempTail->down != NULL) 
-			tempTail = tempTail->down;
-		else
-			break; 
+		if(temp->down == NULL) return temp;
+		temp = temp->down;
 	}
-	if(isFound) return tempHead;
-	return tempTail;
 }
 
-/* Insert node */
+/* Finger search: same result as findPredecessor(key), but starts at bottom level node finger. 
+ * Climbs towers towards key until key is within reach of the current level, then searches down. */
 template <class Key_T, class Mapped_T> 
-Node<Key_T, Mapped_T>* Skiplist<Key_T, Mapped_T> :: insertPair(std::pair<const Key_T, Mapped_T> p) {
-	initialize(p, &head, &tail, DEFAULT_HEIGHT, DEFAULT_HEIGHT);
-	Node<Key_T, Mapped_T>* tempHead = NULL;
-	Node<Key_T, Mapped_T>* tempTail = NULL;
-	Node<Key_T, Mapped_T>* upNode = NULL;
-	// Generate level
-	int lvl = getLevel(); 
-	if(lvl > height && lvl != DEFAULT_LEVEL) {	
-		// Add new level	
-		initialize(p, &tempHead, &tempTail, lvl, size);
-		setUPDownLink(&tempHead, &head);
-		setUPDownLink(&tempTail, &tail);
-		head = tempHead;
-		tail = tempTail;
-	}
-	tempHead = head;
-	tempTail = tail;
-	height = (lvl > height) ? lvl : height; // Update height
-	size++; // Increment size of the skiplist
-	// Traverse tempHead and tempTail to level where we have to insert node
-	for(int i = height; i > lvl; i--) {
-		tempHead = tempHead->down;
-		tempTail = tempTail->down;	
-	}
-	// Insert element in each level starting from the lvl
-	for(; tempHead != NULL; tempHead = tempHead->down) {	
-		Node<Key_T, Mapped_T>* temp = tempHead;
-		for(; temp != tempTail; temp = temp->next) {
-			if(temp->next == tempTail || (!(temp->next->p.first < p.first) && !(temp->next->p.first == p.first))) {				
-				// Create new node to be added in list
-				Node<Key_T, Mapped_T>* newNode = new Node<Key_T, Mapped_T>(p);
-				if(upNode != NULL) {
-					setUPDownLink(&upNode, &newNode);
-				}
-				upNode = newNode;
-				setNextPrevLink(&temp, &newNode);
-				break;
-			}
+Node<Key_T, Mapped_T>* Skiplist<Key_T, Mapped_T> :: fingerSearch(Node<Key_T, Mapped_T>* finger, const Key_T & key) const {
+	Node<Key_T, Mapped_T>* temp = finger;
+	if(temp->prev == NULL || (temp->next != NULL && temp->p.first < key)) {
+		// key is after finger
+		while(temp->next->next != NULL && temp->next->p.first < key) {
+			temp = (temp->up != NULL) ? temp->up : temp->next;
 		}
-		tempTail = tempTail->down;
-		if(tempHead->down == NULL) return temp->next;
+		return searchFrom(temp, key);
 	}
+	// key is at or before finger
+	while(temp->prev->prev != NULL && !(temp->prev->p.first < key)) {
+		temp = (temp->up != NULL) ? temp->up : temp->prev;
+	}
+	return searchFrom(temp->prev, key);
 }
 
-/* Remove node */
+/* Create unlinked tower of lvl nodes, returns its bottom node */
 template <class Key_T, class Mapped_T> 
-void Skiplist<Key_T, Mapped_T> :: removeKey(Key_T key) {
-	bool isRemoved = false;	
-	Node<Key_T, Mapped_T>* temp = NULL;
-	Node<Key_T, Mapped_T>* tempHead = head;
-	for(; tempHead != NULL; tempHead = tempHead->down) {
-		temp = tempHead;
-		while(temp != NULL) {
-			if(temp->prev != NULL && temp->p.first == key) {
-				Node<Key_T, Mapped_T>* prev_temp = temp->prev;
-				freeNode(&prev_temp, &temp);
-				tempHead = prev_temp;
-				isRemoved = true;
-				break;
-			}
-			else if(temp->prev != NULL && !(temp->p.first < key) && !(temp->p.first == key)) {
-				tempHead = temp->prev;
-				break;
-			}
-			temp = temp->next;	
-		}
-		if(tempHead->down == NULL && isRemoved) {
-			size--;
-		}	
-	}		
+Node<Key_T, Mapped_T>* Skiplist<Key_T, Mapped_T> :: makeTower(const std::pair<const Key_T, Mapped_T> & p, int lvl) {
+	Node<Key_T, Mapped_T>* bottom = new Node<Key_T, Mapped_T>(p);
+	Node<Key_T, Mapped_T>* downNode = bottom;
+	for(int i = DEFAULT_LEVEL; i < lvl; i++) {
+		Node<Key_T, Mapped_T>* upNode = new Node<Key_T, Mapped_T>(p);
+		setUPDownLink(&upNode, &downNode);
+		downNode = upNode;
+	}
+	return bottom;
+}
+
+/* Link tower right after prev_node on the bottom level. Predecessors on upper levels are 
+ * found by walking back from prev_node to the nearest taller tower, so no search from head is needed. */
+template <class Key_T, class Mapped_T> 
+void Skiplist<Key_T, Mapped_T> :: linkTower(Node<Key_T, Mapped_T>* node, Node<Key_T, Mapped_T>* prev_node) {
+	int lvl = DEFAULT_HEIGHT;
+	for(Node<Key_T, Mapped_T>* temp = node; temp != NULL; temp = temp->up, lvl++);
+	while(lvl > height) addLevel();
+	for(Node<Key_T, Mapped_T>* temp = node; temp != NULL; temp = temp->up) {
+		setNextPrevLink(&prev_node, &temp);
+		if(temp->up == NULL) break;
+		for( ; prev_node->up == NULL; prev_node = prev_node->prev);
+		prev_node = prev_node->up;
+	}
+	if(size != UNKNOWN_SIZE) size++;
+	if(hashKey != NULL) keysHash += hashKey(node->p.first);
+}
+
+/* Unlink tower from every level, nodes are not freed */
+template <class Key_T, class Mapped_T> 
+void Skiplist<Key_T, Mapped_T> :: unlinkTower(Node<Key_T, Mapped_T>* node) {
+	for(Node<Key_T, Mapped_T>* temp = node; temp != NULL; temp = temp->up) {
+		temp->prev->next = temp->next;
+		temp->next->prev = temp->prev;
+		temp->next = NULL;
+		temp->prev = NULL;
+	}
+	if(size != UNKNOWN_SIZE) size--;
+	if(hashKey != NULL) keysHash -= hashKey(node->p.first);
+}
+
+/* Free all nodes of an unlinked tower */
+template <class Key_T, class Mapped_T> 
+void Skiplist<Key_T, Mapped_T> :: deleteTower(Node<Key_T, Mapped_T>* node) {
+	while(node != NULL) {
+		Node<Key_T, Mapped_T>* upNode = node->up;
+		delete(node);
+		node = upNode;
+	}
+}
+
+/* Count nodes of the bottom level */
+template <class Key_T, class Mapped_T> 
+void Skiplist<Key_T, Mapped_T> :: countSize() const {
+	size = DEFAULT_HEIGHT;
+	for(Node<Key_T, Mapped_T>* temp = bottomHead()->next; temp->next != NULL; temp = temp->next) {
+		size++;
+	}
+}
+
+/* Recompute hash of all keys, counts nodes on the way */
+template <class Key_T, class Mapped_T> 
+void Skiplist<Key_T, Mapped_T> :: rehashKeys() {
+	size = DEFAULT_HEIGHT;
+	keysHash = 0;
+	for(Node<Key_T, Mapped_T>* temp = bottomHead()->next; temp->next != NULL; temp = temp->next) {
+		keysHash += hashKey(temp->p.first);
+		size++;
+	}
+}
+
+/* Hash of key with bits spread by the splitmix64 finalizer, so that summed hashes don't cancel out */
+template <class Key_T, class Mapped_T> 
+template <class Hash>
+std::size_t Skiplist<Key_T, Mapped_T> :: mixedHash(const Key_T & key) {
+	uint64_t h = Hash()(key);
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+	return h ^ (h >> 31);
+}
+
+/* Append pair right after prev_node (head of bottom level if NULL), caller keeps keys in order. 
+ * Used for building maps from sorted input in linear time */
+template <class Key_T, class Mapped_T> 
+Node<Key_T, Mapped_T>* Skiplist<Key_T, Mapped_T> :: insertAfter(const std::pair<const Key_T, Mapped_T> & p, 
+					Node<Key_T, Mapped_T>* prev_node) {
+	if(prev_node == NULL) prev_node = bottomHead();
+	Node<Key_T, Mapped_T>* node = makeTower(p, getLevel());
+	linkTower(node, prev_node);
+	return node;
 }
 
 /*------------------------ Map class method(s) ---------------------------------*/
@@ -471,25 +675,39 @@ Node<Key_T, Mapped_T>* Map<Key_T, Mapped_T> :: retrieveCache(Key_T key) const {
 /* Remove element from cache */
 template <class Key_T, class Mapped_T> 
 void Map<Key_T, Mapped_T> :: removeCache(Key_T key) {
+	if(cache == NULL) return;
 	Cache<Key_T, Mapped_T>* temp = cache;	
 	while(temp->prev != NULL) {
+		Cache<Key_T, Mapped_T>* tempPrev = temp->prev;
 		if(temp->node->p.first == key) {
 			if(temp->next != NULL) {
 				temp->next->prev = temp->prev;
 				temp->prev->next = temp->next;
-				delete(temp);
-				cacheCount--;
 			}
 			else {
 				cache = temp->prev;
-				delete(temp);
 				cache->next = NULL;
 			}
+			delete(temp);
+			cacheCount--;
 		}
-		temp = temp->prev;
+		temp = tempPrev;
 	}
 }
 
+/* Free all cache elements, used when nodes are moved to another map */
+template <class Key_T, class Mapped_T> 
+void Map<Key_T, Mapped_T> :: freeCache() {
+	Cache<Key_T, Mapped_T>* tempCache = cache;
+	while(tempCache != NULL) {
+		Cache<Key_T, Mapped_T>* tempC = tempCache->prev;
+		delete(tempCache);
+		tempCache = tempC;
+	}
+	cache = NULL;
+	cacheCount = 0;
+}
+
 /* Find first node in skiplist */
 template <class Key_T, class Mapped_T> 
 Node<Key_T, Mapped_T>* Map<Key_T, Mapped_T> :: findFirstNode() const {
@@ -518,27 +736,43 @@ Map<Key_T, Mapped_T> :: Map(const Map<Key_T, Mapped_T> &obj) {
 	*this = obj;
 } 
 
-/* Assignment operator */
+/* Move Constructor */
+template <class Key_T, class Mapped_T> 
+Map<Key_T, Mapped_T> :: Map(Map<Key_T, Mapped_T> &&obj) {
+	*this = std::move(obj);
+} 
+
+/* Assignment operator, source is already sorted so every pair is appended at the end */
 template <class Key_T, class Mapped_T> 
 Map<Key_T, Mapped_T>& Map<Key_T, Mapped_T> :: operator=(const Map<Key_T, Mapped_T>& obj) {
-	Node<Key_T, Mapped_T>* tempHead = obj.skiplist.head;
-	Node<Key_T, Mapped_T>* tempTail = obj.skiplist.tail;
-	while(tempHead->down != NULL) {
-		tempHead = tempHead->down;
-		tempTail = tempTail->down;
-	}
-	while(tempHead->next != tempTail) {
-		skiplist.insertPair(tempHead->next->p);
+	if(this == &obj) return *this;
+	clear();
+	skiplist.hashKey = obj.skiplist.hashKey;
+	Node<Key_T, Mapped_T>* tempHead = obj.skiplist.bottomHead();
+	Node<Key_T, Mapped_T>* last = NULL;
+	while(tempHead->next->next != NULL) {
+		last = skiplist.insertAfter(tempHead->next->p, last);
 		tempHead = tempHead->next;
 	}
 	return *this;
 }
 
+/* Move assignment operator, swaps nodes with obj and leaves obj empty */
+template <class Key_T, class Mapped_T> 
+Map<Key_T, Mapped_T>& Map<Key_T, Mapped_T> :: operator=(Map<Key_T, Mapped_T>&& obj) {
+	if(this == &obj) return *this;
+	std::swap(skiplist, obj.skiplist);
+	std::swap(cache, obj.cache);
+	std::swap(cacheCount, obj.cacheCount);
+	obj.clear();
+	return *this;
+}
+
 /* Constructor accepting initializer list*/
 template <class Key_T, class Mapped_T> 
 Map<Key_T, Mapped_T> :: Map(std::initializer_list<std::pair<const Key_T, Mapped_T>> obj) {
 	for (auto li : obj) {
-		skiplist.insertPair(li);
+		insert(li);
 	}
 }
 
@@ -578,51 +812,221 @@ std::pair<typename Map<Key_T, Mapped_T> :: Iterator, bool> Map<Key_T, Mapped_T>
 	return result;
 }
 
-/* Clear all nodes in skiplist */
+/* Insert function with hint, search for the position starts at hint */
+template <class Key_T, class Mapped_T> 
+typename Map<Key_T, Mapped_T> :: Iterator Map<Key_T, Mapped_T> :: insert(Iterator hint, const ValueType & p) {
+	Iterator it;
+	Node<Key_T, Mapped_T>* prev_node = skiplist.fingerSearch(hint.current, p.first);
+	if(prev_node->next->next != NULL && prev_node->next->p.first == p.first) {
+		it.current = prev_node->next;
+		return it;
+	}
+	it.current = skiplist.insertAfter(p, prev_node);
+	return it;
+}
+
+/* Unlink node from the skiplist without freeing it */
+template <class Key_T, class Mapped_T> 
+typename Map<Key_T, Mapped_T> :: NodeHandle Map<Key_T, Mapped_T> :: extract(Iterator pos) {
+	NodeHandle nh;
+	if(pos.current->next == NULL) return nh; // end()
+	removeCache(pos.current->p.first); // Remove node from cache
+	skiplist.unlinkTower(pos.current);
+	skiplist.trimLevels();
+	nh.node = pos.current;
+	return nh;
+}
+
+/* Relink extracted node, nothing is allocated or copied unless the skiplist grows a level */
+template <class Key_T, class Mapped_T> 
+typename Map<Key_T, Mapped_T> :: InsertReturnType Map<Key_T, Mapped_T> :: insert(NodeHandle && nh) {
+	InsertReturnType result;
+	result.inserted = false;
+	if(nh.empty()) {
+		result.position = end();
+		return result;
+	}
+	Node<Key_T, Mapped_T>* prev_node = skiplist.findPredecessor(nh.key());
+	if(prev_node->next->next != NULL && prev_node->next->p.first == nh.key()) {
+		result.position.current = prev_node->next;
+		result.node = std::move(nh);
+		return result;
+	}
+	// Tower may come from a taller skiplist, cut it like getLevel() would so that at most one level is added
+	Node<Key_T, Mapped_T>* top = nh.node;
+	for(int lvl = DEFAULT_LEVEL; top->up != NULL && lvl <= skiplist.height; top = top->up, lvl++);
+	skiplist.deleteTower(top->up);
+	top->up = NULL;
+	skiplist.linkTower(nh.node, prev_node);
+	result.position.current = nh.node;
+	result.inserted = true;
+	nh.node = NULL;
+	return result;
+}
+
+/* Clear all nodes in skiplist, head and tail of the bottom level are kept so end() stays valid */
 template <class Key_T, class Mapped_T>
 void Map<Key_T, Mapped_T> :: clear() {
-	if(skiplist.size == DEFAULT_HEIGHT) return; // Call free only once
-
+	freeCache();
+	Node<Key_T, Mapped_T>* bottomHead = skiplist.bottomHead();
+	Node<Key_T, Mapped_T>* bottomTail = skiplist.tail;
+	for( ; bottomTail->down != NULL; bottomTail = bottomTail->down);
+	
 	Node<Key_T, Mapped_T>* tempHead = skiplist.head;
 	while(tempHead != NULL) {
 		Node<Key_T, Mapped_T>* temp = tempHead;
 		tempHead = tempHead->down;
 		while(temp != NULL) {
 			Node<Key_T, Mapped_T>* tempNext = temp->next;
-			delete(temp);
+			if(temp != bottomHead && temp != bottomTail) delete(temp);
 			temp = tempNext;	
 		}
 	}
-	Cache<Key_T, Mapped_T>* tempCache = cache;
-	while(tempCache != NULL) {
-		Cache<Key_T, Mapped_T>* tempC = tempCache->prev;
-		delete(tempCache);
-		tempCache = tempC;
-		cacheCount--;	
+	skiplist.head = bottomHead;
+	skiplist.tail = bottomTail;
+	skiplist.head->next = skiplist.tail;
+	skiplist.tail->prev = skiplist.head;
+	skiplist.head->up = NULL;
+	skiplist.tail->up = NULL;
+	skiplist.size = DEFAULT_HEIGHT;
+	skiplist.height = DEFAULT_LEVEL;
+	skiplist.keysHash = 0;
+}
+
+/* Splice nodes of obj whose keys are not in this map. Both bottom levels are walked once
+ * in lockstep, towers are relinked without allocating or copying pairs. Elements with 
+ * duplicate keys stay in obj. */
+template <class Key_T, class Mapped_T>
+void Map<Key_T, Mapped_T> :: merge(Map<Key_T, Mapped_T> & obj) {
+	if(this == &obj) return;
+	obj.freeCache(); // Cached nodes may move to this map
+	Node<Key_T, Mapped_T>* prev_node = skiplist.bottomHead();
+	Node<Key_T, Mapped_T>* temp = obj.skiplist.bottomHead()->next;
+	while(temp->next != NULL) {
+		Node<Key_T, Mapped_T>* tempNext = temp->next;
+		while(prev_node->next->next != NULL && prev_node->next->p.first < temp->p.first) {
+			prev_node = prev_node->next;
+		}
+		if(prev_node->next->next == NULL || !(prev_node->next->p.first == temp->p.first)) {
+			obj.skiplist.unlinkTower(temp);
+			skiplist.linkTower(temp, prev_node);
+			prev_node = temp;
+		}
+		temp = tempNext;
 	}
+	obj.skiplist.trimLevels();
+}
+
+/* Cut the map at key: nodes with keys not less than key move to the returned map. Every level 
+ * is cut right after the search path, so this is O(lg(N)). Node counts of both maps are only 
+ * recomputed when size() is asked for. */
+template <class Key_T, class Mapped_T>
+Map<Key_T, Mapped_T> Map<Key_T, Mapped_T> :: split(const Key_T & key) {
+	Map<Key_T, Mapped_T> result;
+	freeCache(); // Cached nodes may move to result
+	while(result.skiplist.height < skiplist.height) result.skiplist.addLevel();
 	
-	skiplist.size = DEFAULT_HEIGHT;
-	skiplist.height = DEFAULT_HEIGHT;
+	Node<Key_T, Mapped_T>* temp = skiplist.head;
+	Node<Key_T, Mapped_T>* tempTail = skiplist.tail;
+	Node<Key_T, Mapped_T>* resHead = result.skiplist.head;
+	Node<Key_T, Mapped_T>* resTail = result.skiplist.tail;
+	Node<Key_T, Mapped_T>* prev_node = NULL;
+	bool isMoved = false;
+	for( ; temp != NULL; temp = temp->down, tempTail = tempTail->down, 
+			resHead = resHead->down, resTail = resTail->down) {
+		while(temp->next != tempTail && temp->next->p.first < key) {
+			temp = temp->next;
+		}
+		prev_node = temp;
+		if(temp->next == tempTail) continue;
+		resHead->next = temp->next;
+		temp->next->prev = resHead;
+		resTail->prev = tempTail->prev;
+		tempTail->prev->next = resTail;
+		temp->next = tempTail;
+		tempTail->prev = temp;
+		isMoved = true;
+	}
+	result.skiplist.hashKey = skiplist.hashKey;
+	if(isMoved && skiplist.hashKey != NULL) { 
+		// Moved keys have to be rehashed, which counts them as well
+		result.skiplist.rehashKeys();
+		skiplist.keysHash -= result.skiplist.keysHash;
+		if(skiplist.size != UNKNOWN_SIZE) skiplist.size -= result.skiplist.size;
+	} else if(isMoved && prev_node->prev == NULL) { // Whole map moved
+		result.skiplist.size = skiplist.size;
+		skiplist.size = DEFAULT_HEIGHT;
+	} else if(isMoved) {
+		result.skiplist.size = UNKNOWN_SIZE;
+		skiplist.size = UNKNOWN_SIZE;
+	}
+	skiplist.trimLevels();
+	result.skiplist.trimLevels();
+	return result;
+}
+
+/* Glue obj to this map, all keys of obj must be greater (or all less) than keys of this map. 
+ * Levels are concatenated pairwise, so this is O(lg(N)) and no node is copied. */
+template <class Key_T, class Mapped_T>
+void Map<Key_T, Mapped_T> :: join(Map<Key_T, Mapped_T> & obj) {
+	if(this == &obj || obj.empty()) return;
+	Node<Key_T, Mapped_T>* tempHead = skiplist.bottomHead();
+	Node<Key_T, Mapped_T>* tempTail = findLastNode();
+	Node<Key_T, Mapped_T>* objHead = obj.skiplist.bottomHead();
+	Node<Key_T, Mapped_T>* objTail = obj.findLastNode();
+	bool isAppend = empty() || tempTail->prev->p.first < objHead->next->p.first;
+	if(!isAppend && !(objTail->prev->p.first < tempHead->next->p.first)) {
+		throw std::invalid_argument("Key ranges overlap!"); 
+	}
+	obj.freeCache(); // Cached nodes move to this map
+	std::size_t objHash = obj.skiplist.keysHash;
+	if(skiplist.hashKey != NULL && obj.skiplist.hashKey != skiplist.hashKey) {
+		objHash = 0;
+		for(Node<Key_T, Mapped_T>* temp = objHead->next; temp != objTail; temp = temp->next) {
+			objHash += skiplist.hashKey(temp->p.first);
+		}
+	}
+	if(skiplist.hashKey != NULL) skiplist.keysHash += objHash;
+	while(skiplist.height < obj.skiplist.height) skiplist.addLevel();
+	
+	for( ; objHead != NULL; tempHead = tempHead->up, tempTail = tempTail->up, 
+			objHead = objHead->up, objTail = objTail->up) {
+		if(objHead->next == objTail) continue;
+		Node<Key_T, Mapped_T>* prev_node = isAppend ? tempTail->prev : tempHead;
+		Node<Key_T, Mapped_T>* first = objHead->next;
+		Node<Key_T, Mapped_T>* last = objTail->prev;
+		last->next = prev_node->next;
+		prev_node->next->prev = last;
+		prev_node->next = first;
+		first->prev = prev_node;
+		objHead->next = objTail;
+		objTail->prev = objHead;
+	}
+	if(skiplist.size != UNKNOWN_SIZE && obj.skiplist.size != UNKNOWN_SIZE) {
+		skiplist.size += obj.skiplist.size;
+	} else {
+		skiplist.size = UNKNOWN_SIZE;
+	}
+	obj.clear(); // Free levels of obj, all of them are empty now
 }
 
 /* ------------------------ Operator Overloading (Friend function)---------------------------  */
 
+/* Maps of different size or, when both keep a hash of their keys, with different keys
+ * are rejected in O(1) */
 template <class Key_T, class Mapped_T> 
 bool operator==(const Map<Key_T, Mapped_T> & m1, const Map<Key_T, Mapped_T> & m2) { 
-	if(m1.skiplist.size != m2.skiplist.size) return false;	
-	int count = 0;
-	Node<Key_T, Mapped_T>* m1_tempHead = m1.skiplist.head;
-	Node<Key_T, Mapped_T>* m2_tempHead = m2.skiplist.head;	
-	
-	for( ; m1_tempHead->down != NULL; m1_tempHead = m1_tempHead->down);
-	for( ; m2_tempHead->down != NULL; m2_tempHead = m2_tempHead->down);
+	if(&m1 == &m2) return true;
+	if(m1.size() != m2.size()) return false;	
+	if(m1.skiplist.hashKey != NULL && m1.skiplist.hashKey == m2.skiplist.hashKey && 
+			m1.skiplist.keysHash != m2.skiplist.keysHash) return false;
 
-	while(m1_tempHead->next != NULL && m1_tempHead->next->p == m2_tempHead->next->p) {
-		count++;
-		m1_tempHead =  m1_tempHead -> next;
-		m2_tempHead =  m2_tempHead -> next;
+	Node<Key_T, Mapped_T>* m1_temp = m1.skiplist.bottomHead()->next;
+	Node<Key_T, Mapped_T>* m2_temp = m2.skiplist.bottomHead()->next;
+	for( ; m1_temp->next != NULL; m1_temp = m1_temp->next, m2_temp = m2_temp->next) {
+		if(!(m1_temp->p == m2_temp->p)) return false;
 	}
-	return count == m1.skiplist.size;
+	return true;
 }
 
 template <class Key_T, class Mapped_T> 
@@ -630,24 +1034,92 @@ bool operator!=(const Map<Key_T, Mapped_T> & m1, const Map<Key_T, Mapped_T> & m2
 	return !(m1 == m2);
 }
 
+/* Lexicographic comparison of (key, value) pairs that only needs operator< of Key_T and Mapped_T. 
+ * Returns negative, zero or positive value like strcmp */
 template <class Key_T, class Mapped_T> 
-bool operator<(const Map<Key_T, Mapped_T> & m1, const Map<Key_T, Mapped_T> & m2) {
-	if(m1.size < m2.size)  return true;
+int compareMaps(const Map<Key_T, Mapped_T> & m1, const Map<Key_T, Mapped_T> & m2) {
+	auto it1 = m1.begin(), it2 = m2.begin();
+	for( ; it1 != m1.end() && it2 != m2.end(); ++it1, ++it2) {
+		if(it1->first < it2->first) return -1;
+		if(it2->first < it1->first) return 1;
+		if(it1->second < it2->second) return -1;
+		if(it2->second < it1->second) return 1;
+	}
+	if(it2 != m2.end()) return -1; // m1 is a prefix of m2
+	return (it1 != m1.end()) ? 1 : 0;
+}
 
-	Node<Key_T, Mapped_T>* m1_tempHead = m1.skiplist.head;
-	Node<Key_T, Mapped_T>* m2_tempHead = m2.skiplist.head;		
-	for( ; m1_tempHead->down != NULL; m1_tempHead = m1_tempHead->down);
-	for( ; m2_tempHead->down != NULL; m2_tempHead = m2_tempHead->down);
-	
-	while(m1_tempHead->next != NULL) {
-		if(m1_tempHead->next->p < m2_tempHead->next->p) {
-			return true;
-		}
-		m1_tempHead =  m1_tempHead -> next;
-		m2_tempHead =  m2_tempHead -> next;
-	}	
-	return false;
+template <class Key_T, class Mapped_T> 
+bool operator<(const Map<Key_T, Mapped_T> & m1, const Map<Key_T, Mapped_T> & m2) {
+	return compareMaps(m1, m2) < 0;
 }	
 
+#if __cpp_impl_three_way_comparison >= 201907L
+template <class Key_T, class Mapped_T> 
+std::weak_ordering operator<=>(const Map<Key_T, Mapped_T> & m1, const Map<Key_T, Mapped_T> & m2) {
+	int result = compareMaps(m1, m2);
+	if(result < 0) return std::weak_ordering::less;
+	if(result > 0) return std::weak_ordering::greater;
+	return std::weak_ordering::equivalent;
+}
+#endif
+
+/* ------------------------ Set operations (Friend function)---------------------------  */
+/* Both maps are walked once in lockstep and the result is built by appending at its end, 
+ * so each producer is linear in m1.size() + m2.size(). */
+
+template <class Key_T, class Mapped_T> 
+Map<Key_T, Mapped_T> set_union(const Map<Key_T, Mapped_T> & m1, const Map<Key_T, Mapped_T> & m2) {
+	Map<Key_T, Mapped_T> result;
+	Node<Key_T, Mapped_T>* last = NULL;
+	auto it1 = m1.begin(), it2 = m2.begin();
+	while(it1 != m1.end() && it2 != m2.end()) {
+		if(it2->first < it1->first) {
+			last = result.skiplist.insertAfter(*it2++, last);
+			continue;
+		}
+		if(it1->first == it2->first) ++it2; // Keep pair of m1 for duplicate keys
+		last = result.skiplist.insertAfter(*it1++, last);
+	}
+	for( ; it1 != m1.end(); ++it1) last = result.skiplist.insertAfter(*it1, last);
+	for( ; it2 != m2.end(); ++it2) last = result.skiplist.insertAfter(*it2, last);
+	return result;
+}
+
+template <class Key_T, class Mapped_T> 
+Map<Key_T, Mapped_T> set_intersection(const Map<Key_T, Mapped_T> & m1, const Map<Key_T, Mapped_T> & m2) {
+	Map<Key_T, Mapped_T> result;
+	Node<Key_T, Mapped_T>* last = NULL;
+	auto it1 = m1.begin(), it2 = m2.begin();
+	while(it1 != m1.end() && it2 != m2.end()) {
+		if(it1->first < it2->first) ++it1;
+		else if(it2->first < it1->first) ++it2;
+		else {
+			last = result.skiplist.insertAfter(*it1++, last);
+			++it2;
+		}
+	}
+	return result;
+}
+
+template <class Key_T, class Mapped_T> 
+Map<Key_T, Mapped_T> set_difference(const Map<Key_T, Mapped_T> & m1, const Map<Key_T, Mapped_T> & m2) {
+	Map<Key_T, Mapped_T> result;
+	Node<Key_T, Mapped_T>* last = NULL;
+	auto it1 = m1.begin(), it2 = m2.begin();
+	while(it1 != m1.end() && it2 != m2.end()) {
+		if(it1->first < it2->first) {
+			last = result.skiplist.insertAfter(*it1++, last);
+		}
+		else if(it2->first < it1->first) ++it2;
+		else {
+			++it1;
+			++it2;
+		}
+	}
+	for( ; it1 != m1.end(); ++it1) last = result.skiplist.insertAfter(*it1, last);
+	return result;
+}
+
 }
 #endif
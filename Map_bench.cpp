@@ -0,0 +1,153 @@
+/*
+ * Benchmarks for cs540::Map. Run with
+ *
+ *    -n entries
+ *
+ * to set the number of entries in each input map (defaults to 5000000).
+ */
+
+// NOTE compile with -O2
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <chrono>
+#include <utility>
+#include <vector>
+#include "Map.hpp"
+
+using map_t = cs540::Map<const int, int>;
+
+static std::chrono::steady_clock::time_point start;
+
+void
+begin_timer() {
+    start = std::chrono::steady_clock::now();
+}
+
+void
+report(const char *name, long ops) {
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-28s %10.3f ms  %8.1f ns/entry\n", name, secs*1e3, secs*1e9/ops);
+}
+
+/*
+ * Merge two maps of n entries each. Keys of the two maps interleave, so every node of
+ * the source has to be relinked somewhere inside the target.
+ */
+
+void
+bench_merge(int n) {
+
+    map_t evens, odds;
+    for (int i = 0; i < n; i++) {
+        evens.insert(std::make_pair(2*i, i));
+        odds.insert(std::make_pair(2*i + 1, i));
+    }
+
+    printf("---- Merge of two %d entry maps\n", n);
+    {
+        map_t a(evens), b(odds);
+        begin_timer();
+        for (auto &e : b) {
+            a.insert(e);
+        }
+        report("insert() loop", n);
+    }
+    {
+        map_t a(evens), b(odds);
+        begin_timer();
+        a.merge(std::move(b));
+        report("merge()", n);
+    }
+    {
+        begin_timer();
+        map_t u = set_union(evens, odds);
+        report("set_union()", 2L*n);
+    }
+
+    // Half of the keys overlap, so intersection and difference produce n/2 entries.
+    map_t shifted;
+    for (int i = 0; i < n; i++) {
+        shifted.insert(std::make_pair(n + 2*i, i));
+    }
+    {
+        begin_timer();
+        map_t r = set_intersection(evens, shifted);
+        report("set_intersection()", 2L*n);
+    }
+    {
+        begin_timer();
+        map_t r = set_difference(evens, shifted);
+        report("set_difference()", 2L*n);
+    }
+}
+
+/*
+ * Ingest n keys arriving sorted, nearly sorted and in random order, with insert() and with
+ * insert() hinted by the position of the previous key.
+ */
+
+void
+bench_ingest(int n) {
+
+    std::vector<int> sorted(n), nearly(n), random(n);
+    for (int i = 0; i < n; i++) {
+        sorted[i] = i;
+        // Each key is at most 64 positions away from its sorted position.
+        nearly[i] = 8*i + rand()%512;
+        random[i] = rand();
+    }
+
+    struct { const char *name; const std::vector<int> &keys; } inputs[] = {
+        {"sorted", sorted}, {"nearly sorted", nearly}, {"random", random}
+    };
+
+    printf("---- Ingest of %d keys\n", n);
+    for (auto &in : inputs) {
+        char name[64];
+        {
+            map_t map;
+            begin_timer();
+            for (int k : in.keys) {
+                map.insert(std::make_pair(k, k));
+            }
+            snprintf(name, sizeof name, "%s insert()", in.name);
+            report(name, n);
+        }
+        {
+            map_t map;
+            auto hint = map.end();
+            begin_timer();
+            for (int k : in.keys) {
+                hint = map.insert(hint, std::make_pair(k, k));
+            }
+            snprintf(name, sizeof name, "%s insert(hint)", in.name);
+            report(name, n);
+        }
+    }
+}
+
+int
+main(int argc, char *argv[]) {
+
+    int n = 5000000;
+
+    {
+        int c;
+        while ((c = getopt(argc, argv, "n:")) != EOF) {
+            switch (c) {
+                case 'n':
+                    n = atoi(optarg);
+                    break;
+                case '?':
+                    fprintf(stderr, "Unrecog.\n");
+                    exit(1);
+            }
+        }
+    }
+
+    srand48(1234);
+
+    bench_merge(n);
+    bench_ingest(n);
+}
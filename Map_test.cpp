@@ -57,6 +57,12 @@ struct Person {
     Person &operator=(const Person &) = delete;
 };
 
+struct PersonHash {
+    std::size_t operator()(const Person &p) const {
+        return std::hash<std::string>()(p.name);
+    }
+};
+
 void
 print(const std::pair<const Person, int> &p) {
     p.first.print();
@@ -117,6 +123,16 @@ void traverse2(int level);
 template <template <typename, typename> class MAP_T>
 void check(const MAP_T<const Stress, double> &, const std::map<const Stress, double> &);
 
+/*
+ * Tests for operations that only cs540::Map has.
+ */
+
+void test_set_operations();
+void test_split_join();
+void test_comparisons();
+void test_finger_search();
+void test_node_handles();
+
 /*
  * The actual test code.  It's a template so that it can be run with the std::map and the
  * assignment Map.
@@ -557,6 +573,11 @@ main(int argc, char *argv[]) {
         run_test<test_map>(iterations);
     } else {
         run_test<cs540::Map>(iterations);
+        test_set_operations();
+        test_split_join();
+        test_comparisons();
+        test_finger_search();
+        test_node_handles();
     }
 }
 
@@ -618,3 +639,371 @@ traverse2(int level) {
         }
     }
 }
+
+// Test merge() and the linear set operations against std::map.
+void
+test_set_operations() {
+
+    using map_t = cs540::Map<const int, int>;
+    using mirror_t = std::map<const int, int>;
+
+    map_t m1, m2;
+    mirror_t r1, r2;
+    for (int i = 0; i < 2000; i++) {
+        int k1 = rand()%3000, k2 = rand()%3000;
+        m1.insert(std::make_pair(k1, 1)); r1.insert(std::make_pair(k1, 1));
+        m2.insert(std::make_pair(k2, 2)); r2.insert(std::make_pair(k2, 2));
+    }
+
+    auto same = [](const map_t &m, const mirror_t &r) {
+        assert(m.size() == int(r.size()));
+        auto it = m.begin();
+        for (auto &e : r) {
+            assert(it != m.end() && (*it).first == e.first && (*it).second == e.second);
+            ++it;
+        }
+        assert(it == m.end());
+    };
+
+    {
+        mirror_t r(r1);
+        r.insert(r2.begin(), r2.end());
+        same(set_union(m1, m2), r);
+    }
+    {
+        mirror_t r;
+        for (auto &e : r1) if (r2.count(e.first)) r.insert(e);
+        same(set_intersection(m1, m2), r);
+    }
+    {
+        mirror_t r;
+        for (auto &e : r1) if (!r2.count(e.first)) r.insert(e);
+        same(set_difference(m1, m2), r);
+    }
+
+    // Merge keeps duplicates in the source and moves every other node.
+    {
+        map_t a(m1), b(m2);
+        auto moved = b.find(r2.begin()->first);
+        bool moves = r1.count(r2.begin()->first) == 0;
+        a.merge(b);
+
+        mirror_t ra(r1), rb;
+        for (auto &e : r2) {
+            if (!ra.insert(e).second) rb.insert(e);
+        }
+        same(a, ra);
+        same(b, rb);
+        // Iterators to moved elements stay valid and now walk the target map.
+        if (moves) {
+            assert((*moved).second == 2);
+            assert(a.find(r2.begin()->first) == moved);
+        }
+
+        // Both maps stay usable.
+        b.insert(std::make_pair(-1, 0));
+        a.erase(r1.begin()->first);
+        assert(b.find(-1) != b.end());
+        assert(a.find(r1.begin()->first) == a.end());
+    }
+
+    // Merging into and from empty maps.
+    {
+        map_t a, b(m1);
+        a.merge(std::move(b));
+        same(a, r1);
+        assert(b.empty() && b.begin() == b.end());
+        a.merge(b);
+        same(a, r1);
+    }
+}
+
+// Test split() and join() against std::map.
+void
+test_split_join() {
+
+    using map_t = cs540::Map<const int, int>;
+    using mirror_t = std::map<const int, int>;
+
+    map_t map;
+    mirror_t mirror;
+    for (int i = 0; i < 3000; i++) {
+        int k = rand()%5000;
+        map.insert(std::make_pair(k, i));
+        mirror.insert(std::make_pair(k, i));
+    }
+
+    auto same = [](const map_t &m, mirror_t::const_iterator b, mirror_t::const_iterator e) {
+        assert(m.size() == int(std::distance(b, e)));
+        assert(m.empty() == (b == e));
+        auto it = m.begin();
+        for ( ; b != e; ++b, ++it) {
+            assert(it != m.end() && (*it).first == b->first && (*it).second == b->second);
+        }
+        assert(it == m.end());
+    };
+
+    for (int key : {-1, 0, 1234, 2500, 4999, 5000, 6000}) {
+        map_t copy(map);
+        auto lo_end = copy.end();
+        auto lb = mirror.lower_bound(key);
+
+        // Keep iterators to elements on both sides of the cut.
+        auto first = copy.begin();
+        auto moved = copy.find(lb == mirror.end() ? -1 : lb->first);
+
+        map_t hi = copy.split(key);
+        same(copy, mirror.begin(), lb);
+        same(hi, lb, mirror.end());
+        assert(copy.end() == lo_end);
+
+        // Iterators to moved nodes stay valid and walk the new map.
+        if (lb != mirror.begin()) {
+            assert((*first).first == mirror.begin()->first);
+        }
+        if (lb != mirror.end()) {
+            assert(moved == hi.begin());
+            assert(hi.find(lb->first) == moved);
+        }
+
+        // Both halves stay usable.
+        hi.insert(std::make_pair(10000, 0));
+        hi.erase(10000);
+        copy.insert(std::make_pair(-10, 0));
+        copy.erase(-10);
+
+        // Join back in either order.
+        if (key % 2 == 0) {
+            copy.join(hi);
+            same(copy, mirror.begin(), mirror.end());
+            assert(copy == map);
+            assert(hi.empty());
+        } else {
+            hi.join(std::move(copy));
+            same(hi, mirror.begin(), mirror.end());
+            assert(hi == map);
+        }
+    }
+
+    // Overlapping key ranges can't be joined.
+    {
+        map_t a(map), b(map);
+        try {
+            a.join(b);
+            assert(false);
+        } catch (std::invalid_argument &) {
+        }
+        same(a, mirror.begin(), mirror.end());
+        same(b, mirror.begin(), mirror.end());
+    }
+}
+
+// Test comparison operators against std::map and the key hash kept by enableContentHash().
+void
+test_comparisons() {
+
+    using map_t = cs540::Map<const int, int>;
+    using mirror_t = std::map<const int, int>;
+
+    std::vector<std::pair<map_t, mirror_t>> maps(40);
+    for (auto &m : maps) {
+        int n = rand()%6;
+        for (int i = 0; i < n; i++) {
+            int k = rand()%4, v = rand()%3;
+            m.first.insert(std::make_pair(k, v));
+            m.second.insert(std::make_pair(k, v));
+        }
+    }
+    for (auto &a : maps) {
+        for (auto &b : maps) {
+            assert((a.first == b.first) == (a.second == b.second));
+            assert((a.first != b.first) == (a.second != b.second));
+            assert((a.first < b.first) == (a.second < b.second));
+#if __cpp_impl_three_way_comparison >= 201907L
+            assert(((a.first <=> b.first) < 0) == (a.second < b.second));
+            assert(((a.first <=> b.first) == 0) == (a.second == b.second));
+#endif
+        }
+    }
+
+    // The key hash must match a fresh hash of the same keys after every kind of update.
+    auto rehashed = [](const map_t &m) {
+        map_t copy;
+        for (auto &e : m) {
+            copy.insert(e);
+        }
+        copy.enableContentHash();
+        return copy.contentHash();
+    };
+
+    map_t m1, m2;
+    m1.enableContentHash();
+    m2.enableContentHash();
+    for (int i = 0; i < 500; i++) {
+        m1.insert(std::make_pair(rand()%1000, i));
+        m2.insert(std::make_pair(rand()%1000, i));
+    }
+    assert(m1.contentHash() == rehashed(m1));
+    for (int i = 0; i < 100; i++) {
+        m1.erase(rand()%1000);
+    }
+    m1[2000] = 1;
+    assert(m1.contentHash() == rehashed(m1));
+
+    map_t m3(m1);
+    assert(m3.contentHash() == m1.contentHash() && m3 == m1);
+    m3.erase(m3.begin());
+    assert(m3 != m1);
+
+    m1.merge(m2);
+    assert(m1.contentHash() == rehashed(m1));
+    assert(m2.contentHash() == rehashed(m2));
+
+    map_t hi = m1.split(500);
+    assert(m1.contentHash() == rehashed(m1));
+    assert(hi.contentHash() == rehashed(hi));
+    m1.join(hi);
+    assert(m1.contentHash() == rehashed(m1));
+
+    // Same keys with different values still compare the values.
+    map_t a, b;
+    a.enableContentHash();
+    b.enableContentHash();
+    a.insert(std::make_pair(1, 1));
+    b.insert(std::make_pair(1, 2));
+    assert(a.contentHash() == b.contentHash());
+    assert(a != b && a < b && !(b < a));
+}
+
+// Test insert() with hint and find_from() from random starting points.
+void
+test_finger_search() {
+
+    using map_t = cs540::Map<const int, int>;
+    using mirror_t = std::map<const int, int>;
+
+    map_t map;
+    mirror_t mirror;
+    std::vector<map_t::Iterator> iters;
+    iters.push_back(map.end());
+
+    for (int i = 0; i < 5000; i++) {
+        auto hint = iters[rand()%iters.size()];
+        // Mostly keys close to the hint, sometimes far away.
+        int k = rand()%4000;
+        if (hint != map.end() && rand()%4 != 0) {
+            k = (*hint).first + rand()%21 - 10;
+        }
+        auto it = map.insert(hint, std::make_pair(k, i));
+        auto mir = mirror.insert(std::make_pair(k, i));
+        assert((*it).first == k && (*it).second == mir.first->second);
+        if (mir.second) {
+            iters.push_back(it);
+        }
+    }
+    assert(map.size() == int(mirror.size()));
+    auto mit = mirror.begin();
+    for (auto &e : map) {
+        assert(e.first == mit->first && e.second == mit->second);
+        ++mit;
+    }
+
+    iters.push_back(map.begin());
+    iters.push_back(map.end());
+    for (int i = 0; i < 5000; i++) {
+        auto hint = iters[rand()%iters.size()];
+        int k = rand()%4100 - 50;
+        auto it = map.find_from(hint, k);
+        if (mirror.count(k)) {
+            assert(it != map.end() && (*it).first == k);
+            assert(it == map.find(k));
+        } else {
+            assert(it == map.end());
+        }
+        const map_t &cmap = map;
+        assert(cmap.find_from(cmap.begin(), k) == it);
+        // Successor search.
+        auto lb = map.lower_bound(k);
+        auto mlb = mirror.lower_bound(k);
+        assert((lb == map.end()) == (mlb == mirror.end()));
+        assert(lb == map.end() || ((*lb).first == mlb->first && cmap.lower_bound(k) == lb));
+    }
+    map_t empty;
+    assert(empty.lower_bound(0) == empty.end());
+
+    // Sorted ingest with the previous position as hint.
+    map_t sorted;
+    auto hint = sorted.end();
+    for (int i = 0; i < 1000; i++) {
+        hint = sorted.insert(hint, std::make_pair(i, i));
+    }
+    assert(sorted.size() == 1000);
+    int i = 0;
+    for (auto &e : sorted) {
+        assert(e.first == i++);
+    }
+}
+
+// Test moving elements between maps with extract() and insert() of node handles.
+void
+test_node_handles() {
+
+    using map_t = cs540::Map<const Person, int>;
+
+    map_t hot, cold;
+    for (int i = 0; i < 200; i++) {
+        char name[30];
+        sprintf(name, "Jane%03d", i);
+        hot.insert(std::make_pair(Person(name), i));
+    }
+    hot.enableContentHash<PersonHash>();
+    cold.enableContentHash<PersonHash>();
+
+    // Move every other element to the cold map.
+    for (int i = 0; i < 200; i += 2) {
+        char name[30];
+        sprintf(name, "Jane%03d", i);
+        auto it = hot.find(Person(name));
+        const std::pair<const Person, int> *addr = &*it;
+
+        auto nh = hot.extract(it);
+        assert(!nh.empty() && nh.key() == Person(name) && nh.mapped() == i);
+        assert(hot.find(Person(name)) == hot.end());
+        nh.mapped() = -i;
+
+        auto res = cold.insert(std::move(nh));
+        assert(res.inserted && res.node.empty());
+        // Same node, nothing was copied.
+        assert(&*res.position == addr);
+        assert(cold.find(Person(name)) == res.position);
+        assert((*res.position).second == -i);
+    }
+    assert(hot.size() == 100 && cold.size() == 100);
+
+    // Both maps must be sorted and keep their key hashes.
+    for (auto *m : {&hot, &cold}) {
+        const Person *prev = nullptr;
+        for (auto &e : *m) {
+            assert(prev == nullptr || *prev < e.first);
+            prev = &e.first;
+        }
+        map_t copy(*m);
+        copy.enableContentHash<PersonHash>();
+        assert(copy.contentHash() == m->contentHash());
+    }
+
+    // Inserting a duplicate key hands the node back.
+    {
+        auto nh = cold.extract(Person("Jane000"));
+        cold.insert(std::make_pair(Person("Jane000"), 7));
+        auto res = cold.insert(std::move(nh));
+        assert(!res.inserted && !res.node.empty());
+        assert((*res.position).second == 7 && res.node.mapped() == 0);
+    }
+
+    // Missing keys give empty handles.
+    assert(hot.extract(Person("Nobody")).empty());
+    assert(hot.extract(hot.end()).empty());
+    auto res = hot.insert(map_t::NodeHandle());
+    assert(!res.inserted && res.position == hot.end());
+}
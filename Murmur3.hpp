@@ -0,0 +1,950 @@
+#ifndef MURMUR3_HPP
+#define MURMUR3_HPP
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#if __cplusplus > 201703L && __has_include(<bit>)
+#include <bit>
+#endif
+#if defined(__SSE4_1__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * 4 bytes of a key as a little endian block. Compilers turn it into a single load, and unlike
+ * memcpy() it works on char keys at compile time.
+ */
+template <typename Byte>
+constexpr uint32_t murmur3_load32(const Byte* p)
+{
+    return uint32_t(uint8_t(p[0])) | (uint32_t(uint8_t(p[1])) << 8) | (uint32_t(uint8_t(p[2])) << 16)
+        | (uint32_t(uint8_t(p[3])) << 24);
+}
+
+/**
+ * 8 bytes of a key as a little endian block, a single load like murmur3_load32()
+ */
+template <typename Byte>
+constexpr uint64_t murmur3_load64(const Byte* p)
+{
+    return uint64_t(murmur3_load32(p)) | (uint64_t(murmur3_load32(p + 4)) << 32);
+}
+
+/**
+ * The last n < 8 bytes of a key as a little endian number
+ */
+template <typename Byte>
+constexpr uint64_t murmur3_load_tail64(const Byte* p, size_t n)
+{
+    uint64_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        k |= uint64_t(uint8_t(p[i])) << (8 * i);
+    }
+    return k;
+}
+
+/**
+ * Standard Murmur3 algorithm thats accepts key value in byte array and its length
+ * return hashing result. Keys of char work at compile time, murmur3_32("topic", 5) is a constant.
+ */
+template <typename Byte, typename = std::enable_if_t<sizeof(Byte) == 1 && std::is_integral_v<Byte>>>
+constexpr uint32_t murmur3_32(const Byte* key, size_t len, uint32_t seed = 0) {
+    uint32_t h = seed;
+    if (len > 3) {
+        size_t i = len >> 2;
+        do {
+            uint32_t k = murmur3_load32(key);
+            key += 4;
+            k *= 0xcc9e2d51;
+            k = (k << 15) | (k >> 17);
+            k *= 0x1b873593;
+            h ^= k;
+            h = (h << 13) | (h >> 19);
+            h = (h * 5) + 0xe6546b64;
+        } while (--i);
+    }
+    if (len & 3) {
+        size_t i = len & 3;
+        uint32_t k = 0;
+        key = &key[i - 1];
+        do {
+            k <<= 8;
+            k |= uint8_t(*key--);
+        } while (--i);
+        k *= 0xcc9e2d51;
+        k = (k << 15) | (k >> 17);
+        k *= 0x1b873593;
+        h ^= k;
+    }
+    h ^= len;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * Incremental murmur3_32: init(), then update() with the key in as many pieces as wanted, then
+ * finalize(). Gives the same hash as murmur3_32 on all the pieces put together. Up to 3 bytes
+ * that don't make a whole block are carried over to the next update().
+ */
+class murmur3_32_stream
+{
+    public:
+
+        using result_type = uint32_t;
+
+        constexpr explicit murmur3_32_stream(uint32_t seed = 0)
+        {
+            init(seed);
+        }
+
+        constexpr void init(uint32_t seed = 0)
+        {
+            h = seed;
+            carry = 0;
+            carry_len = 0;
+            len = 0;
+        }
+
+        template <typename Byte>
+        constexpr void update(const Byte* key, size_t n)
+        {
+            len += n;
+            if (carry_len != 0) {
+                for (; n != 0 && carry_len < 4; n--) {
+                    carry |= uint32_t(uint8_t(*key++)) << (8 * carry_len++);
+                }
+                if (carry_len < 4) {
+                    return;
+                }
+                h = mix(h, carry);
+                carry = 0;
+                carry_len = 0;
+            }
+            for (; n >= 4; n -= 4, key += 4) {
+                h = mix(h, murmur3_load32(key));
+            }
+            for (; n != 0; n--) {
+                carry |= uint32_t(uint8_t(*key++)) << (8 * carry_len++);
+            }
+        }
+
+        /**
+         * Takes the n low bytes of u as update() takes n bytes little endian, straight from a
+         * register. Numbers and the lengths of strings come in this way.
+         */
+        constexpr void update_le(uint64_t u, size_t n)
+        {
+            len += n;
+            // The carry followed by the n bytes, up to 11 bytes in hi:lo
+            uint64_t lo = carry_len != 0 ? (u << (8 * carry_len)) | carry : u;
+            uint64_t hi = carry_len != 0 ? u >> (64 - 8 * carry_len) : 0;
+            size_t total = carry_len + n;
+            if (total >= 8) {
+                h = mix(mix(h, uint32_t(lo)), uint32_t(lo >> 32));
+                lo = hi;
+                total -= 8;
+            } else if (total >= 4) {
+                h = mix(h, uint32_t(lo));
+                lo >>= 32;
+                total -= 4;
+            }
+            carry = uint32_t(lo);
+            carry_len = unsigned(total);
+        }
+
+        constexpr uint32_t finalize() const
+        {
+            return fmix(carry_len != 0 ? h ^ scramble(carry) : h, len);
+        }
+
+        /**
+         * Steps of the hash, shared with murmur3_32_batch(): one round on a 4 byte block, the
+         * final mix of a len byte key, and the rest of a key from its state h after some rounds
+         */
+        static constexpr uint32_t scramble(uint32_t k)
+        {
+            k *= 0xcc9e2d51;
+            k = (k << 15) | (k >> 17);
+            return k * 0x1b873593;
+        }
+
+        static constexpr uint32_t mix(uint32_t h, uint32_t k)
+        {
+            h ^= scramble(k);
+            h = (h << 13) | (h >> 19);
+            return (h * 5) + 0xe6546b64;
+        }
+
+        static constexpr uint32_t fmix(uint32_t h, size_t len)
+        {
+            h ^= len;
+            h ^= h >> 16;
+            h *= 0x85ebca6b;
+            h ^= h >> 13;
+            h *= 0xc2b2ae35;
+            h ^= h >> 16;
+            return h;
+        }
+
+        template <typename Byte>
+        static constexpr uint32_t finish(uint32_t h, const Byte* key, size_t rest, size_t len)
+        {
+            for (; rest >= 4; rest -= 4, key += 4) {
+                h = mix(h, murmur3_load32(key));
+            }
+            if (rest != 0) {
+                uint32_t k = 0;
+                for (size_t i = rest; i > 0; i--) {
+                    k = (k << 8) | uint8_t(key[i - 1]);
+                }
+                h ^= scramble(k);
+            }
+            return fmix(h, len);
+        }
+
+    private:
+
+        uint32_t h = 0;
+        uint32_t carry = 0;
+        unsigned carry_len = 0;
+        size_t len = 0;
+};
+
+/**
+ * 128 bit result of murmur3_x64_128, h1 and h2 as in the reference implementation
+ */
+struct murmur3_128_t
+{
+    uint64_t h1;
+    uint64_t h2;
+
+    bool operator==(const murmur3_128_t& other) const { return h1 == other.h1 && h2 == other.h2; }
+    bool operator!=(const murmur3_128_t& other) const { return !(*this == other); }
+};
+
+/**
+ * Incremental murmur3_x64_128, same interface as murmur3_32_stream. Takes 16 bytes a round in
+ * two independent halves, up to 15 bytes are carried over to the next update().
+ */
+class murmur3_x64_128_stream
+{
+    public:
+
+        using result_type = murmur3_128_t;
+
+        explicit murmur3_x64_128_stream(uint32_t seed = 0)
+        {
+            init(seed);
+        }
+
+        void init(uint32_t seed = 0)
+        {
+            h1 = seed;
+            h2 = seed;
+            carry_len = 0;
+            len = 0;
+        }
+
+        template <typename Byte, typename = std::enable_if_t<sizeof(Byte) == 1>>
+        void update(const Byte* bytes, size_t n)
+        {
+            const uint8_t* key = reinterpret_cast<const uint8_t*>(bytes);
+            len += n;
+            if (carry_len != 0) {
+                size_t take = n < 16 - carry_len ? n : 16 - carry_len;
+                std::memcpy(carry + carry_len, key, take);
+                carry_len += take;
+                key += take;
+                n -= take;
+                if (carry_len < 16) {
+                    return;
+                }
+                mix(h1, h2, carry);
+                carry_len = 0;
+            }
+            for (; n >= 16; n -= 16, key += 16) {
+                mix(h1, h2, key);
+            }
+            std::memcpy(carry, key, n);
+            carry_len = n;
+        }
+
+        murmur3_128_t finalize() const
+        {
+            return finish(h1, h2, carry, carry_len, len);
+        }
+
+        /**
+         * One round on a 16 byte block, and the tail and final mix, shared with murmur3_x64_128()
+         */
+        static void mix(uint64_t& h1, uint64_t& h2, const uint8_t* block)
+        {
+            uint64_t k1 = murmur3_load64(block), k2 = murmur3_load64(block + 8);
+            h1 ^= scramble1(k1);
+            h1 = rotl64(h1, 27);
+            h1 += h2;
+            h1 = h1 * 5 + 0x52dce729;
+            h2 ^= scramble2(k2);
+            h2 = rotl64(h2, 31);
+            h2 += h1;
+            h2 = h2 * 5 + 0x38495ab5;
+        }
+
+        static murmur3_128_t finish(uint64_t h1, uint64_t h2, const uint8_t* tail, size_t tail_len, size_t len)
+        {
+            // The tail is read little endian like the blocks, the same hash on every machine
+            if (tail_len > 8) {
+                h2 ^= scramble2(murmur3_load_tail64(tail + 8, tail_len - 8));
+            }
+            if (tail_len > 0) {
+                h1 ^= scramble1(tail_len < 8 ? murmur3_load_tail64(tail, tail_len) : murmur3_load64(tail));
+            }
+            h1 ^= len;
+            h2 ^= len;
+            h1 += h2;
+            h2 += h1;
+            h1 = fmix64(h1);
+            h2 = fmix64(h2);
+            h1 += h2;
+            h2 += h1;
+            return murmur3_128_t{h1, h2};
+        }
+
+    private:
+
+        static uint64_t rotl64(uint64_t x, int r)
+        {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        static uint64_t scramble1(uint64_t k)
+        {
+            k *= 0x87c37b91114253d5ULL;
+            k = rotl64(k, 31);
+            return k * 0x4cf5ad432745937fULL;
+        }
+
+        static uint64_t scramble2(uint64_t k)
+        {
+            k *= 0x4cf5ad432745937fULL;
+            k = rotl64(k, 33);
+            return k * 0x87c37b91114253d5ULL;
+        }
+
+        static uint64_t fmix64(uint64_t k)
+        {
+            k ^= k >> 33;
+            k *= 0xff51afd7ed558ccdULL;
+            k ^= k >> 33;
+            k *= 0xc4ceb9fe1a85ec53ULL;
+            k ^= k >> 33;
+            return k;
+        }
+
+        uint64_t h1;
+        uint64_t h2;
+        uint8_t carry[16];
+        size_t carry_len;
+        size_t len;
+};
+
+/**
+ * Murmur3 x64 128 bit variant, for long keys, fewer collisions and more bits to shard on
+ */
+inline murmur3_128_t murmur3_x64_128(const uint8_t* key, size_t len, uint32_t seed = 0) {
+    uint64_t h1 = seed, h2 = seed;
+    const uint8_t* end = key + (len & ~size_t(15));
+    for (; key != end; key += 16) {
+        murmur3_x64_128_stream::mix(h1, h2, key);
+    }
+    return murmur3_x64_128_stream::finish(h1, h2, key, len & 15, len);
+}
+
+#if defined(__AVX2__)
+/**
+ * murmur3_32 rounds and final mix on 8 keys at a time, a key per 32 bit lane
+ */
+inline __m256i murmur3_32_scramble8(__m256i k)
+{
+    k = _mm256_mullo_epi32(k, _mm256_set1_epi32(int(0xcc9e2d51)));
+    k = _mm256_or_si256(_mm256_slli_epi32(k, 15), _mm256_srli_epi32(k, 17));
+    return _mm256_mullo_epi32(k, _mm256_set1_epi32(int(0x1b873593)));
+}
+
+inline __m256i murmur3_32_mix8(__m256i h, __m256i k)
+{
+    h = _mm256_xor_si256(h, murmur3_32_scramble8(k));
+    h = _mm256_or_si256(_mm256_slli_epi32(h, 13), _mm256_srli_epi32(h, 19));
+    return _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(h, 2), h), _mm256_set1_epi32(int(0xe6546b64)));
+}
+
+inline __m256i murmur3_32_fmix8(__m256i h, size_t len)
+{
+    h = _mm256_xor_si256(h, _mm256_set1_epi32(int(uint32_t(len))));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(int(0x85ebca6b)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(int(0xc2b2ae35)));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+}
+
+/**
+ * murmur3_32 of 8 keys of key_len bytes, one after the other from keys. Rows of 16, 8 or 4 bytes
+ * of keys l and l + 4 are loaded into the halves of a vector and transposed, so that a vector
+ * holds the same block of all 8 keys. No gathers, they are slow on some processors.
+ */
+inline void murmur3_32_x8(const uint8_t* keys, size_t key_len, uint32_t* out, uint32_t seed)
+{
+    size_t blocks_end = key_len & ~size_t(3);
+    __m256i h = _mm256_set1_epi32(int(seed));
+    __m256i v[4];
+    size_t b = 0;
+    for (; b + 16 <= blocks_end; b += 16) {
+        for (size_t l = 0; l < 4; l++) {
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + l * key_len + b));
+            __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + (l + 4) * key_len + b));
+            v[l] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        }
+        __m256i t0 = _mm256_unpacklo_epi32(v[0], v[1]), t1 = _mm256_unpackhi_epi32(v[0], v[1]);
+        __m256i t2 = _mm256_unpacklo_epi32(v[2], v[3]), t3 = _mm256_unpackhi_epi32(v[2], v[3]);
+        h = murmur3_32_mix8(h, _mm256_unpacklo_epi64(t0, t2));
+        h = murmur3_32_mix8(h, _mm256_unpackhi_epi64(t0, t2));
+        h = murmur3_32_mix8(h, _mm256_unpacklo_epi64(t1, t3));
+        h = murmur3_32_mix8(h, _mm256_unpackhi_epi64(t1, t3));
+    }
+    if (b + 8 <= blocks_end) {
+        for (size_t l = 0; l < 4; l++) {
+            __m128i lo = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(keys + l * key_len + b));
+            __m128i hi = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(keys + (l + 4) * key_len + b));
+            v[l] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        }
+        __m256i t0 = _mm256_unpacklo_epi32(v[0], v[1]), t2 = _mm256_unpacklo_epi32(v[2], v[3]);
+        h = murmur3_32_mix8(h, _mm256_unpacklo_epi64(t0, t2));
+        h = murmur3_32_mix8(h, _mm256_unpackhi_epi64(t0, t2));
+        b += 8;
+    }
+    if (b < blocks_end) {
+        for (size_t l = 0; l < 4; l++) {
+            int lo, hi;
+            std::memcpy(&lo, keys + l * key_len + b, 4);
+            std::memcpy(&hi, keys + (l + 4) * key_len + b, 4);
+            v[l] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_cvtsi32_si128(lo)), _mm_cvtsi32_si128(hi), 1);
+        }
+        h = murmur3_32_mix8(h, _mm256_unpacklo_epi64(_mm256_unpacklo_epi32(v[0], v[1]), _mm256_unpacklo_epi32(v[2], v[3])));
+    }
+    if (key_len & 3) {
+        uint32_t tail[8];
+        for (size_t l = 0; l < 8; l++) {
+            tail[l] = 0;
+            for (size_t i = key_len; i > blocks_end; i--) {
+                tail[l] = (tail[l] << 8) | keys[l * key_len + i - 1];
+            }
+        }
+        h = _mm256_xor_si256(h, murmur3_32_scramble8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail))));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), murmur3_32_fmix8(h, key_len));
+}
+#elif defined(__SSE4_1__)
+/**
+ * murmur3_32 rounds and final mix on 4 keys at a time, a key per 32 bit lane
+ */
+inline __m128i murmur3_32_scramble4(__m128i k)
+{
+    k = _mm_mullo_epi32(k, _mm_set1_epi32(int(0xcc9e2d51)));
+    k = _mm_or_si128(_mm_slli_epi32(k, 15), _mm_srli_epi32(k, 17));
+    return _mm_mullo_epi32(k, _mm_set1_epi32(int(0x1b873593)));
+}
+
+inline __m128i murmur3_32_mix4(__m128i h, __m128i k)
+{
+    h = _mm_xor_si128(h, murmur3_32_scramble4(k));
+    h = _mm_or_si128(_mm_slli_epi32(h, 13), _mm_srli_epi32(h, 19));
+    return _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(h, 2), h), _mm_set1_epi32(int(0xe6546b64)));
+}
+
+inline __m128i murmur3_32_fmix4(__m128i h, size_t len)
+{
+    h = _mm_xor_si128(h, _mm_set1_epi32(int(uint32_t(len))));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+    h = _mm_mullo_epi32(h, _mm_set1_epi32(int(0x85ebca6b)));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 13));
+    h = _mm_mullo_epi32(h, _mm_set1_epi32(int(0xc2b2ae35)));
+    return _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+}
+
+/**
+ * murmur3_32 of 4 keys of key_len bytes, one after the other from keys. Rows of 16, 8 or 4 bytes
+ * of the keys are loaded and transposed, so that a vector holds the same block of all 4 keys.
+ */
+inline void murmur3_32_x4(const uint8_t* keys, size_t key_len, uint32_t* out, uint32_t seed)
+{
+    size_t blocks_end = key_len & ~size_t(3);
+    __m128i h = _mm_set1_epi32(int(seed));
+    __m128i v[4];
+    size_t b = 0;
+    for (; b + 16 <= blocks_end; b += 16) {
+        for (size_t l = 0; l < 4; l++) {
+            v[l] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + l * key_len + b));
+        }
+        __m128i t0 = _mm_unpacklo_epi32(v[0], v[1]), t1 = _mm_unpackhi_epi32(v[0], v[1]);
+        __m128i t2 = _mm_unpacklo_epi32(v[2], v[3]), t3 = _mm_unpackhi_epi32(v[2], v[3]);
+        h = murmur3_32_mix4(h, _mm_unpacklo_epi64(t0, t2));
+        h = murmur3_32_mix4(h, _mm_unpackhi_epi64(t0, t2));
+        h = murmur3_32_mix4(h, _mm_unpacklo_epi64(t1, t3));
+        h = murmur3_32_mix4(h, _mm_unpackhi_epi64(t1, t3));
+    }
+    if (b + 8 <= blocks_end) {
+        for (size_t l = 0; l < 4; l++) {
+            v[l] = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(keys + l * key_len + b));
+        }
+        __m128i t0 = _mm_unpacklo_epi32(v[0], v[1]), t2 = _mm_unpacklo_epi32(v[2], v[3]);
+        h = murmur3_32_mix4(h, _mm_unpacklo_epi64(t0, t2));
+        h = murmur3_32_mix4(h, _mm_unpackhi_epi64(t0, t2));
+        b += 8;
+    }
+    if (b < blocks_end) {
+        for (size_t l = 0; l < 4; l++) {
+            int k;
+            std::memcpy(&k, keys + l * key_len + b, 4);
+            v[l] = _mm_cvtsi32_si128(k);
+        }
+        h = murmur3_32_mix4(h, _mm_unpacklo_epi64(_mm_unpacklo_epi32(v[0], v[1]), _mm_unpacklo_epi32(v[2], v[3])));
+    }
+    if (key_len & 3) {
+        uint32_t tail[4];
+        for (size_t l = 0; l < 4; l++) {
+            tail[l] = 0;
+            for (size_t i = key_len; i > blocks_end; i--) {
+                tail[l] = (tail[l] << 8) | keys[l * key_len + i - 1];
+            }
+        }
+        h = _mm_xor_si128(h, murmur3_32_scramble4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail))));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), murmur3_32_fmix4(h, key_len));
+}
+#endif
+
+/**
+ * Hashes of n keys of key_len bytes each, one after the other from keys, into out. The same
+ * hashes as murmur3_32 on each key. With AVX2 8 keys (4 with SSE4.1) go through the rounds
+ * together, one per vector lane.
+ */
+inline void murmur3_32_batch(const uint8_t* keys, size_t key_len, size_t n, uint32_t* out, uint32_t seed = 0)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i < n - n % 8; i += 8) {
+        murmur3_32_x8(keys + i * key_len, key_len, out + i, seed);
+    }
+#elif defined(__SSE4_1__)
+    for (; i < n - n % 4; i += 4) {
+        murmur3_32_x4(keys + i * key_len, key_len, out + i, seed);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = murmur3_32(keys + i * key_len, key_len, seed);
+    }
+}
+
+/**
+ * Hashes of n keys of any length, keys[i] is lens[i] bytes. Four keys go through their rounds
+ * side by side while all of them have blocks left, so the multiplications of one key overlap
+ * with those of the others, then each is finished on its own.
+ */
+inline void murmur3_32_batch(const uint8_t* const* keys, const size_t* lens, size_t n, uint32_t* out, uint32_t seed = 0)
+{
+    size_t i = 0;
+    for (; i < n - n % 4; i += 4) {
+        size_t common = lens[i];
+        for (size_t j = 1; j < 4; j++) {
+            common = lens[i + j] < common ? lens[i + j] : common;
+        }
+        common &= ~size_t(3);
+        uint32_t h[4] = {seed, seed, seed, seed};
+        for (size_t b = 0; b < common; b += 4) {
+            for (size_t j = 0; j < 4; j++) {
+                h[j] = murmur3_32_stream::mix(h[j], murmur3_load32(keys[i + j] + b));
+            }
+        }
+        for (size_t j = 0; j < 4; j++) {
+            out[i + j] = murmur3_32_stream::finish(h[j], keys[i + j] + common, lens[i + j] - common, lens[i + j]);
+        }
+    }
+    for (; i < n; i++) {
+        out[i] = murmur3_32(keys[i], lens[i], seed);
+    }
+}
+
+// std::index_sequence implementation
+
+template<size_t ...>
+struct sequence { };
+
+template<size_t N, size_t... Is>
+struct generate : generate<N - 1, N - 1, Is...> { };
+
+template<size_t... Is>
+struct generate<0, Is...> : sequence<Is...> { };
+
+// End std::index_sequence implementation
+
+/**
+ * Serialization of other key types: specialize murmur3_traits<T> with a static write(hash, value)
+ * that passes the members that make up the key to convert_to_byte, one after the other. Hashing
+ * the bytes of a struct would take in its padding and the byte order of the machine.
+ */
+template<typename T>
+struct murmur3_traits
+{
+    template<typename Hash>
+    static constexpr void write(Hash&, const T&)
+    {
+        static_assert(sizeof(T) == 0, "specialize murmur3_traits<T> to hash this type");
+    }
+};
+
+/**
+ * n bytes of u to a hash little endian, through a fixed stack buffer for hashes that only take
+ * bytes. murmur3_32_stream takes them without the buffer.
+ */
+template<typename Hash>
+constexpr void murmur3_update_le(Hash& hash, uint64_t u, size_t n)
+{
+    uint8_t bytes[8] = {};
+#pragma GCC unroll 8
+    for (std::size_t k = 0; k < n; k++)
+    {
+         bytes[k] = uint8_t(u >> (8 * k));
+    }
+    hash.update(bytes, n);
+}
+
+constexpr void murmur3_update_le(murmur3_32_stream& hash, uint64_t u, size_t n)
+{
+    hash.update_le(u, n);
+}
+
+/**
+ * Bytes convert_to_byte gives for a T of a fixed size (numbers, enums), 0 for other types
+ */
+template<typename T>
+constexpr size_t murmur3_fixed_size()
+{
+    if constexpr ((std::is_integral_v<T> || std::is_enum_v<T>) && sizeof(T) <= 8)
+    {
+        return sizeof(T);
+    }
+    else if constexpr (std::is_floating_point_v<T> && (sizeof(T) == 4 || sizeof(T) == 8))
+    {
+        return sizeof(T);
+    }
+    return 0;
+}
+
+/**
+ * Function template convert_to_byte for numbers and enums, the bytes of the value go to the hash
+ * little endian whatever the byte order of the machine, so every service hashes a key the same.
+ * -0.0 is hashed as 0.0 and all NaNs as the same quiet NaN, they compare equal as keys. Numbers
+ * are taken apart with shifts, so they hash at compile time, floating point only where there is
+ * std::bit_cast. Other types go through murmur3_traits.
+ */
+template<typename Hash, typename T>
+constexpr void convert_to_byte(Hash& hash, const T & val)
+{
+    if constexpr (murmur3_fixed_size<T>() != 0)
+    {
+        using U = std::conditional_t<sizeof(T) == 1, uint8_t, std::conditional_t<sizeof(T) == 2, uint16_t,
+            std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+        U u = 0;
+        if constexpr (std::is_floating_point_v<T>)
+        {
+#if __cpp_lib_bit_cast >= 201806L
+            u = std::bit_cast<U>(val);
+#else
+            std::memcpy(&u, &val, sizeof u);
+#endif
+            // Above the bits of infinity is NaN, without the sign bit 0 is 0.0
+            constexpr U sign = U(1) << (8 * sizeof(T) - 1);
+            constexpr U infinity = sizeof(T) == 4 ? U(0x7f800000) : U(0x7ff0000000000000);
+            constexpr U quiet_nan = sizeof(T) == 4 ? U(0x7fc00000) : U(0x7ff8000000000000);
+            U magnitude = u & ~sign;
+            u = magnitude > infinity ? quiet_nan : (magnitude == 0 ? 0 : u);
+        }
+        else
+        {
+            u = static_cast<U>(val);
+        }
+        murmur3_update_le(hash, u, sizeof(T));
+    }
+    else
+    {
+        murmur3_traits<T>::write(hash, val);
+    }
+}
+
+/**
+ * Overloads of convert_to_byte function which take strings: "char *" up to the '\0', which
+ * string literals and other char arrays decay to, std::string_view and std::string. The length
+ * goes first as 4 bytes, so ("ab", "c") and ("a", "bc") are different keys.
+ */
+template<typename Hash>
+constexpr void convert_to_byte(Hash& hash, std::string_view const & val)
+{
+    murmur3_update_le(hash, uint32_t(val.size()), 4);
+    hash.update(val.data(), val.size());
+}
+
+template<typename Hash>
+constexpr void convert_to_byte(Hash& hash, const char * const & val)
+{
+    std::size_t len = 0;
+    while (val[len] != '\0')
+    {
+        len++;
+    }
+    convert_to_byte(hash, std::string_view(val, len));
+}
+
+template<typename Hash>
+constexpr void convert_to_byte(Hash& hash, char * const & val)
+{
+    convert_to_byte(hash, static_cast<const char *>(val));
+}
+
+template<typename Hash>
+void convert_to_byte(Hash& hash, std::string const & val)
+{
+    convert_to_byte(hash, std::string_view(val));
+}
+
+/**
+ * Gives the bytes of all the values of a key to a hash, one value after the other
+ */
+template<typename Hash, typename... Ts>
+constexpr void murmur3_write(Hash& hash, const Ts&... args)
+{
+    (convert_to_byte(hash, args), ...);
+}
+
+/**
+ * Hashes keys made of Args... with murmur3_32 (Bits = 32) or murmur3_x64_128 (Bits = 128), under
+ * the seed it was made with. The default seed 0 gives the same hashes in every process, for keys
+ * that are stored or sent elsewhere; hash tables facing keys from outside should take a random one.
+ */
+template <unsigned Bits, typename... Args>
+class basic_murmur3
+{
+    static_assert(Bits == 32 || Bits == 128, "murmur3 hashes are 32 or 128 bits");
+
+    public:
+
+        using stream_type = std::conditional_t<Bits == 128, murmur3_x64_128_stream, murmur3_32_stream>;
+        using result_type = typename stream_type::result_type;
+
+    private:
+
+        uint32_t key_seed;
+
+        /**
+         * unpack the parameter to extract the value from the tuple, feed them to the hash
+         */
+        template<typename Hash, typename T, size_t... Is>
+        static constexpr void for_each(Hash& hash, const T& t, sequence<Is...>)
+        {
+            murmur3_write(hash, std::get<Is>(t)...);
+        }
+
+        /**
+         * Takes the bytes convert_to_byte gives a hash and lays them out one after the other
+         */
+        struct byte_writer
+        {
+            uint8_t* p;
+            template <typename Byte>
+            void update(const Byte* bytes, size_t n)
+            {
+                // Short strings, copied in place rather than through a call to memcpy()
+                size_t k = 0;
+                for (; k + 8 <= n; k += 8) {
+                    std::memcpy(p + k, bytes + k, 8);
+                }
+                for (; k < n; k++) {
+                    p[k] = uint8_t(bytes[k]);
+                }
+                p += n;
+            }
+        };
+
+        /**
+         * Counts the bytes convert_to_byte gives a hash, to size the buffer of keys with strings
+         */
+        struct byte_counter
+        {
+            size_t n;
+            template <typename Byte>
+            void update(const Byte*, size_t k)
+            {
+                n += k;
+            }
+        };
+
+    public:
+
+        constexpr explicit basic_murmur3(uint32_t seed = 0) : key_seed(seed) { }
+
+        constexpr uint32_t seed() const
+        {
+            return key_seed;
+        }
+
+        /**
+         * Hashes the key values straight from the arguments, nothing is copied or allocated
+         */
+        constexpr result_type apply(const Args&... args) const
+        {
+            stream_type hash(key_seed);
+            murmur3_write(hash, args...);
+            return hash.finalize();
+        }
+
+        /**
+         * Takes a function that returns a tuple of the key values and hashes the tuple it returns
+         */
+        template <typename F, typename = std::enable_if_t<std::is_invocable_r_v<std::tuple<Args...>, F&>>>
+        result_type apply(F&& func) const
+        {
+            const std::tuple<Args...>& key_tuple = func();
+            stream_type hash(key_seed);
+            for_each(hash, key_tuple, generate<sizeof...(Args)>());
+            return hash.finalize();
+        }
+
+        /**
+         * Hashes of n keys into out, the same as apply() on each. Keys are laid out in groups as the
+         * bytes apply() would hash and go to murmur3_32_batch(): keys of numbers only side by side in
+         * lanes of the same width, keys with strings one after the other to the interleaved streams
+         * for keys of any length. 128 bit hashes are worked out one key at a time.
+         */
+        void apply_batch(const std::tuple<Args...>* keys, size_t n, result_type* out) const
+        {
+            size_t i = 0;
+            if constexpr (Bits == 32 && (std::is_arithmetic_v<Args> && ...)) {
+                constexpr size_t key_len = (size_t(0) + ... + sizeof(Args));
+                constexpr size_t GROUP = 64;
+                uint8_t bytes[GROUP * (key_len != 0 ? key_len : 1)];
+                for (; i < n; i += GROUP) {
+                    size_t m = n - i < GROUP ? n - i : GROUP;
+                    for (size_t j = 0; j < m; j++) {
+                        byte_writer writer{bytes + j * key_len};
+                        for_each(writer, keys[i + j], generate<sizeof...(Args)>());
+                    }
+                    murmur3_32_batch(bytes, key_len, m, out + i, key_seed);
+                }
+            } else if constexpr (Bits == 32) {
+                constexpr size_t GROUP = 64;
+                std::vector<uint8_t> bytes;
+                const uint8_t* ptrs[GROUP];
+                size_t lens[GROUP];
+                for (; i < n; i += GROUP) {
+                    size_t m = n - i < GROUP ? n - i : GROUP;
+                    size_t total = 0;
+                    for (size_t j = 0; j < m; j++) {
+                        byte_counter counter{0};
+                        for_each(counter, keys[i + j], generate<sizeof...(Args)>());
+                        lens[j] = counter.n;
+                        total += counter.n;
+                    }
+                    if (bytes.size() < total) {
+                        bytes.resize(total);
+                    }
+                    byte_writer writer{bytes.data()};
+                    for (size_t j = 0; j < m; j++) {
+                        ptrs[j] = writer.p;
+                        for_each(writer, keys[i + j], generate<sizeof...(Args)>());
+                    }
+                    murmur3_32_batch(ptrs, lens, m, out + i, key_seed);
+                }
+            } else {
+                for (; i < n; i++) {
+                    stream_type hash(key_seed);
+                    for_each(hash, keys[i], generate<sizeof...(Args)>());
+                    out[i] = hash.finalize();
+                }
+            }
+        }
+};
+
+template <typename... Args>
+using murmur3 = basic_murmur3<32, Args...>;
+
+template <typename... Args>
+using murmur3_128 = basic_murmur3<128, Args...>;
+
+/**
+ * Seed drawn from std::random_device the first time it is asked for, then the same for the rest of
+ * the process. Keys crafted to collide under seed 0, or under the seed of an earlier run, land
+ * anywhere under it. It only holds the seed secret: murmur3 has known collisions that don't depend
+ * on the seed, so it is no match for a keyed hash like SipHash against someone who knows them.
+ */
+inline uint32_t murmur3_process_seed()
+{
+    static const uint32_t seed = std::random_device()();
+    return seed;
+}
+
+/**
+ * A new seed every call, for giving each table its own: the hash of a counter under the process
+ * seed, which costs far less than reading the random device again.
+ */
+inline uint32_t murmur3_random_seed()
+{
+    static std::atomic<uint64_t> count{0};
+    return murmur3<uint64_t>(murmur3_process_seed()).apply(count.fetch_add(1, std::memory_order_relaxed));
+}
+
+/**
+ * murmur3_32 of a key given as values, the same bytes as murmur3<Args...>::apply(). Numbers,
+ * enums and strings other than std::string hash at compile time, so the hash of a constant key
+ * can be a case label.
+ */
+template <typename... Ts>
+constexpr uint32_t murmur3_hash(const Ts&... args)
+{
+    murmur3_32_stream hash;
+    murmur3_write(hash, args...);
+    return hash.finalize();
+}
+
+/**
+ * Smallest seed under which murmur3_32 of every key lands in a different one of slots slots, for
+ * building perfect hash tables at compile time. Returns UINT32_MAX if no seed below max_seed does.
+ */
+template <size_t N>
+constexpr uint32_t murmur3_perfect_seed(const std::string_view (& keys)[N], size_t slots, uint32_t max_seed = 1000)
+{
+    for (uint32_t seed = 0; seed < max_seed; seed++) {
+        bool used[N * 8 + 64] = {};
+        bool is_perfect = slots <= sizeof used;
+        for (size_t i = 0; i < N && is_perfect; i++) {
+            size_t slot = murmur3_32(keys[i].data(), keys[i].size(), seed) % slots;
+            is_perfect = !used[slot];
+            used[slot] = true;
+        }
+        if (is_perfect) {
+            return seed;
+        }
+    }
+    return UINT32_MAX;
+}
+#endif
@@ -0,0 +1,283 @@
+/*
+ * Benchmarks for murmur3 on composite keys and on byte strings of 8 B to 1 MB. Run with
+ *
+ *    -n hashes
+ *
+ * to set the number of keys hashed by each composite key case (defaults to 10000000). Each case
+ * hashes different keys, and sums the hashes so they can't be optimized out. Byte strings are
+ * hashed about 256 MB worth for each size, from an address that is not aligned. Cycles are
+ * TSC cycles where there is a TSC.
+ */
+
+// NOTE compile with -O2
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "Murmur3.hpp"
+
+using clk = std::chrono::steady_clock;
+
+template <typename F>
+void
+bench(const char *name, long n, F hash) {
+    uint32_t sum = 0;
+    auto start = clk::now();
+    for (long i = 0; i < n; i++) {
+        sum += hash(i);
+    }
+    double secs = std::chrono::duration<double>(clk::now() - start).count();
+    printf("%-40s %8.1f ns/hash  %8.2f Mhash/s  (%08x)\n", name, secs*1e9/n, n/secs/1e6, sum);
+}
+
+/*
+ * How murmur3<Args...>::apply() used to hash: the keys come from a std::function as a tuple,
+ * and every byte is pushed into a new vector.
+ */
+
+template <typename T>
+void
+push_bytes(std::vector<unsigned char> &bytes, const T &val) {
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(&val);
+    for (std::size_t k = 0; k < sizeof(T); k++) {
+        bytes.push_back(p[sizeof(T) - k - 1]);
+    }
+}
+
+void
+push_bytes(std::vector<unsigned char> &bytes, char *const &str) {
+    for (char *p = str; *p != '\0'; p++) {
+        bytes.push_back(*p);
+    }
+}
+
+void
+push_bytes(std::vector<unsigned char> &bytes, const std::string &str) {
+    for (std::size_t i = 0; i != str.size(); ++i) {
+        bytes.push_back(str[i]);
+    }
+}
+
+template <typename... Args>
+struct vector_murmur3 {
+    static uint32_t apply(std::function<std::tuple<Args...>()> &&func) {
+        auto key_tuple = func();
+        std::vector<unsigned char> bytes;
+        std::apply([&](const auto &... args) { (push_bytes(bytes, args), ...); }, key_tuple);
+        return murmur3_32(bytes.data(), bytes.size());
+    }
+};
+
+unsigned long long
+cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Hash size bytes over and over, each time from the next byte of a buffer so the key moves
+ * around, and print bytes per cycle and GB/s.
+ */
+
+template <typename F>
+void
+bench_bytes(const char *name, std::size_t size, F hash) {
+    std::vector<uint8_t> buf(size + 64);
+    for (std::size_t i = 0; i < buf.size(); i++) {
+        buf[i] = uint8_t(i*131 + 7);
+    }
+    long iters = std::max(16L, long((256 << 20)/size));
+    uint64_t sum = 0;
+    auto start = clk::now();
+    unsigned long long c = cycles();
+    for (long i = 0; i < iters; i++) {
+        sum += hash(buf.data() + 1 + i%63, size);
+    }
+    c = cycles() - c;
+    double secs = std::chrono::duration<double>(clk::now() - start).count();
+    double bytes = double(size)*iters;
+    printf("%-18s %8zu B  %6.2f B/cycle  %7.2f GB/s  %8.1f ns/hash  (%08x)\n",
+        name, size, c ? bytes/c : 0.0, bytes/secs/1e9, secs*1e9/iters, unsigned(sum));
+}
+
+/*
+ * Hash n_keys keys with hash_all(out) over and over, about n keys in all, and print the time per
+ * key and a sum of the hashes of the first pass.
+ */
+
+template <typename R, typename F>
+void
+bench_batch(const char *name, long n, std::size_t n_keys, F hash_all) {
+    std::vector<R> out(n_keys);
+    long passes = std::max(1L, long(n/n_keys));
+    auto start = clk::now();
+    for (long i = 0; i < passes; i++) {
+        hash_all(out.data());
+    }
+    double secs = std::chrono::duration<double>(clk::now() - start).count();
+    uint32_t sum = 0;
+    for (auto &h : out) {
+        sum += uint32_t(h);
+    }
+    printf("%-40s %8.2f ns/key  %8.2f Mkeys/s  (%08x)\n", name, secs*1e9/(passes*n_keys), passes*n_keys/secs/1e6, sum);
+}
+
+int
+main(int argc, char *argv[]) {
+
+    long n = 10000000;
+
+    {
+        int c;
+        while ((c = getopt(argc, argv, "n:")) != EOF) {
+            switch (c) {
+                case 'n':
+                    n = atol(optarg);
+                    break;
+                case '?':
+                    fprintf(stderr, "Unrecog.\n");
+                    exit(1);
+            }
+        }
+    }
+
+    char chars[] = "Hello";
+    std::string str = "Hello World";
+
+    murmur3<char, int, float, double, char *, std::string> mixed;
+    bench("(char, int, float, double, char*, string)", n, [&](long i) {
+        return mixed.apply('a', int(i), i*0.5f, i*0.25, chars, str);
+    });
+    bench("  from a std::function, by vector", n, [&](long i) {
+        return vector_murmur3<char, int, float, double, char *, std::string>::apply([&]() {
+            return std::tuple<char, int, float, double, char *, std::string>('a', int(i), i*0.5f, i*0.25, chars, str);
+        });
+    });
+
+    murmur3<int, int> pair;
+    bench("(int, int)", n, [&](long i) {
+        return pair.apply(int(i), int(i >> 3));
+    });
+    bench("  from a std::function, by vector", n, [&](long i) {
+        return vector_murmur3<int, int>::apply([&]() { return std::tuple<int, int>(int(i), int(i >> 3)); });
+    });
+
+    murmur3<std::string, long> named;
+    const std::string topic = "orders.eu-west.partition";
+    bench("(string, long)", n, [&](long i) {
+        return named.apply(topic, i);
+    });
+    bench("  from a std::function, by vector", n, [&](long i) {
+        return vector_murmur3<std::string, long>::apply([&]() { return std::tuple<std::string, long>(topic, i); });
+    });
+
+    for (std::size_t size : {8, 16, 64, 256, 1024, 4096, 65536, 1 << 20}) {
+        bench_bytes("murmur3_32", size, [](const uint8_t *key, std::size_t len) {
+            return murmur3_32(key, len);
+        });
+        bench_bytes("murmur3_x64_128", size, [](const uint8_t *key, std::size_t len) {
+            return murmur3_x64_128(key, len).h1;
+        });
+    }
+
+    // Many keys at once against a key at a time.
+    const std::size_t n_keys = 4096;
+    std::vector<uint8_t> bytes(n_keys*64 + 64);
+    for (std::size_t i = 0; i < bytes.size(); i++) {
+        bytes[i] = uint8_t(i*131 + 7);
+    }
+    for (std::size_t len : {8, 17, 32}) {
+        char name[64];
+        snprintf(name, sizeof name, "%zu B keys, loop", len);
+        bench_batch<uint32_t>(name, n, n_keys, [&](uint32_t *out) {
+            for (std::size_t i = 0; i < n_keys; i++) {
+                out[i] = murmur3_32(bytes.data() + i*len, len);
+            }
+        });
+        snprintf(name, sizeof name, "%zu B keys, murmur3_32_batch()", len);
+        bench_batch<uint32_t>(name, n, n_keys, [&](uint32_t *out) {
+            murmur3_32_batch(bytes.data(), len, n_keys, out);
+        });
+    }
+    for (std::size_t len : {16, 256}) {
+        std::vector<const uint8_t *> ptrs;
+        std::vector<std::size_t> lens;
+        for (std::size_t i = 0; i < n_keys; i++) {
+            ptrs.push_back(bytes.data() + (i*61)%(n_keys*64 - 4*len));
+            lens.push_back(len + (i*37)%(3*len));
+        }
+        char name[64];
+        snprintf(name, sizeof name, "%zu-%zu B keys, loop", len, 4*len);
+        bench_batch<uint32_t>(name, n, n_keys, [&](uint32_t *out) {
+            for (std::size_t i = 0; i < n_keys; i++) {
+                out[i] = murmur3_32(ptrs[i], lens[i]);
+            }
+        });
+        snprintf(name, sizeof name, "%zu-%zu B keys, murmur3_32_batch()", len, 4*len);
+        bench_batch<uint32_t>(name, n, n_keys, [&](uint32_t *out) {
+            murmur3_32_batch(ptrs.data(), lens.data(), n_keys, out);
+        });
+    }
+
+    std::vector<std::tuple<char, int, float, double>> nums;
+    std::vector<std::tuple<char, int, float, double, char *, std::string>> keys;
+    for (std::size_t i = 0; i < n_keys; i++) {
+        nums.emplace_back('a' + i%26, int(i), i*0.5f, i*0.25);
+        keys.emplace_back('a' + i%26, int(i), i*0.5f, i*0.25, chars, str);
+    }
+    murmur3<char, int, float, double> m_nums;
+    bench_batch<uint32_t>("(char, int, float, double), apply()", n, n_keys, [&](uint32_t *out) {
+        for (std::size_t i = 0; i < n_keys; i++) {
+            out[i] = std::apply([&](auto... v) { return m_nums.apply(v...); }, nums[i]);
+        }
+    });
+    bench_batch<uint32_t>("(char, int, float, double), apply_batch()", n, n_keys, [&](uint32_t *out) {
+        m_nums.apply_batch(nums.data(), n_keys, out);
+    });
+    bench_batch<uint32_t>("(... char*, string), apply()", n, n_keys, [&](uint32_t *out) {
+        for (std::size_t i = 0; i < n_keys; i++) {
+            out[i] = std::apply([&](const auto &... v) { return mixed.apply(v...); }, keys[i]);
+        }
+    });
+    bench_batch<uint32_t>("(... char*, string), apply_batch()", n, n_keys, [&](uint32_t *out) {
+        mixed.apply_batch(keys.data(), n_keys, out);
+    });
+
+    // Keys with strings of different lengths: a user and a number, and user, session, topic.
+    std::vector<std::tuple<std::string, long>> users;
+    std::vector<std::tuple<std::string, std::string, std::string>> sessions;
+    for (std::size_t i = 0; i < n_keys; i++) {
+        std::string user = "user" + std::to_string(i*7919 % 1000003);
+        users.emplace_back(user, long(i));
+        sessions.emplace_back(user, "session-" + std::to_string(i*31), std::string("topic/") + std::string(i%40, 'x'));
+    }
+    murmur3<std::string, long> m_users;
+    murmur3<std::string, std::string, std::string> m_sessions;
+    bench_batch<uint32_t>("(string, long), apply()", n, n_keys, [&](uint32_t *out) {
+        for (std::size_t i = 0; i < n_keys; i++) {
+            out[i] = std::apply([&](const auto &... v) { return m_users.apply(v...); }, users[i]);
+        }
+    });
+    bench_batch<uint32_t>("(string, long), apply_batch()", n, n_keys, [&](uint32_t *out) {
+        m_users.apply_batch(users.data(), n_keys, out);
+    });
+    bench_batch<uint32_t>("(string, string, string), apply()", n, n_keys, [&](uint32_t *out) {
+        for (std::size_t i = 0; i < n_keys; i++) {
+            out[i] = std::apply([&](const auto &... v) { return m_sessions.apply(v...); }, sessions[i]);
+        }
+    });
+    bench_batch<uint32_t>("(string, string, string), apply_batch()", n, n_keys, [&](uint32_t *out) {
+        m_sessions.apply_batch(sessions.data(), n_keys, out);
+    });
+}
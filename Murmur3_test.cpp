@@ -0,0 +1,329 @@
+#include "Murmur3.hpp"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+// The bytes murmur3<Args...> hashes for a value: numbers little endian, strings after their length.
+template <typename T>
+void
+append_bytes(std::vector<uint8_t> &bytes, const T &val) {
+    uint64_t u = uint64_t(val);
+    if constexpr (std::is_floating_point_v<T>) {
+        std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t> bits;
+        memcpy(&bits, &val, sizeof bits);
+        u = bits;
+    }
+    for (std::size_t k = 0; k < sizeof(T); k++) {
+        bytes.push_back(uint8_t(u >> 8*k));
+    }
+}
+
+void
+append_bytes(std::vector<uint8_t> &bytes, const std::string &str) {
+    append_bytes(bytes, uint32_t(str.size()));
+    bytes.insert(bytes.end(), str.begin(), str.end());
+}
+
+uint32_t
+hash_str(const char *str, uint32_t seed = 0) {
+    return murmur3_32(reinterpret_cast<const uint8_t *>(str), strlen(str), seed);
+}
+
+murmur3_128_t
+hash128_str(const char *str, uint32_t seed = 0) {
+    return murmur3_x64_128(reinterpret_cast<const uint8_t *>(str), strlen(str), seed);
+}
+
+// Feed key to a stream in three pieces, cut at i and j.
+template <typename Stream>
+typename Stream::result_type
+hash_pieces(const std::vector<uint8_t> &key, std::size_t len, std::size_t i, std::size_t j) {
+    Stream s(42);
+    s.update(key.data(), i);
+    s.update(key.data() + i, j - i);
+    s.update(key.data() + j, len - j);
+    return s.finalize();
+}
+
+// A key with padding between its members, hashed as its members.
+struct Point {
+    char tag;
+    double x;
+};
+
+template <>
+struct murmur3_traits<Point> {
+    template <typename Hash>
+    static constexpr void write(Hash &hash, const Point &p) {
+        convert_to_byte(hash, p.tag);
+        convert_to_byte(hash, p.x);
+    }
+};
+
+enum class Topic : uint16_t { orders = 3, users = 7 };
+
+// Routes with case labels hashed at compile time.
+int
+route(const std::string &topic, int partition) {
+    switch (murmur3_hash(topic, partition)) {
+        case murmur3_hash("orders", 0):
+            return 1;
+        case murmur3_hash("orders", 1):
+            return 2;
+        case murmur3_hash("users", 0):
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+int
+main() {
+
+    // Test known values.
+    assert(hash_str("") == 0);
+    assert(hash_str("", 1) == 0x514e28b7);
+    assert(hash_str("", 0xffffffff) == 0x81f16f39);
+    assert(hash_str("test") == 0xba6bd213);
+    assert(hash_str("Hello, world!") == 0xc0363e43);
+    assert(hash_str("Hello, world!", 0x9747b28c) == 0x24884cba);
+    assert(hash_str("The quick brown fox jumps over the lazy dog") == 0x2e4ff723);
+    assert(hash128_str("") == (murmur3_128_t{0, 0}));
+    assert(hash128_str("hello") == (murmur3_128_t{0xcbd8a7b341bd9b02, 0x5b1e906a48ae1d19}));
+    assert(hash128_str("The quick brown fox jumps over the lazy dog")
+        == (murmur3_128_t{0xe34bbc7bbc071b6c, 0x7a433ca9c49a9347}));
+    assert(hash128_str("Hello, world!", 123) == (murmur3_128_t{0x421c8c738743acad, 0xf19732fdd373c3f5}));
+
+    // Test that keys hash to the same values on every machine: numbers little endian, strings after
+    // their length as 4 bytes. Any other murmur3_32 of these bytes gives the same.
+    {
+        static_assert(murmur3_hash(uint32_t(1)) == 0xfbf1402a, "");
+        static_assert(murmur3_hash("orders", 3) == 0xecc6e30e, "");
+        assert(murmur3_hash(12.5, -1L) == 0x841d43c2);
+        assert(murmur3_hash(std::string("user"), 'x', true) == 0x058b138a);
+        const uint8_t le[] = {4, 3, 2, 1};
+        assert(murmur3_hash(uint32_t(0x01020304)) == murmur3_32(le, 4));
+        assert(murmur3_hash(int16_t(-2)) == murmur3_hash(uint16_t(0xfffe)));
+
+        // Keys that compare equal hash the same.
+        assert(murmur3_hash(-0.0) == murmur3_hash(0.0) && murmur3_hash(-0.0f) == murmur3_hash(0.0f));
+        double nan = std::numeric_limits<double>::quiet_NaN();
+        assert(murmur3_hash(nan) == murmur3_hash(-nan));
+        assert(murmur3_hash(nan) == murmur3_hash(std::numeric_limits<double>::signaling_NaN()));
+        assert(murmur3_hash(std::numeric_limits<float>::quiet_NaN()) == murmur3_hash(-std::numeric_limits<float>::quiet_NaN()));
+        assert(murmur3_hash(0.0) != murmur3_hash(std::numeric_limits<double>::denorm_min()));
+        std::string str = "orders";
+        char chars[] = "orders";
+        assert(murmur3_hash(str, 3) == murmur3_hash("orders", 3) && murmur3_hash(chars, 3) == murmur3_hash("orders", 3));
+        assert(murmur3_hash(std::string_view(str), 3) == murmur3_hash("orders", 3));
+
+        // Strings are length prefixed, so where one ends and the next starts is part of the key.
+        assert(murmur3_hash("ab", "c") != murmur3_hash("a", "bc"));
+        assert(murmur3_hash("", "abc") != murmur3_hash("abc", ""));
+        assert(murmur3_hash("abc") != murmur3_hash("abc", ""));
+
+        // User types hash as their members, whatever is in the padding.
+        Point p1, p2;
+        memset(&p1, 0x00, sizeof p1);
+        memset(&p2, 0xff, sizeof p2);
+        p1.tag = p2.tag = 'p';
+        p1.x = p2.x = 1.5;
+        assert(murmur3_hash(p1) == murmur3_hash(p2) && murmur3_hash(p1) == murmur3_hash('p', 1.5));
+        assert((murmur3<Point, int>().apply(p1, 7) == murmur3_hash('p', 1.5, 7)));
+    }
+
+    // Test that hashes computed at compile time are the same as at run time.
+    {
+        static_assert(murmur3_32("test", 4) == 0xba6bd213, "");
+        static_assert(murmur3_32("Hello, world!", 13, 0x9747b28c) == 0x24884cba, "");
+        constexpr uint32_t h = murmur3_hash("topic", 42);
+        std::string topic = "topic";
+        char chars[] = "topic";
+        assert((h == murmur3<std::string, int>().apply(topic, 42)));
+        assert((h == murmur3<char *, int>().apply(chars, 42)));
+        assert(h == murmur3_hash(topic, 42) && h == murmur3_hash(std::string_view(topic), 42));
+        constexpr uint32_t h_enum = murmur3<int, Topic, char, bool, long>().apply(-1, Topic::users, 'x', true, 1L << 40);
+        volatile int minus_one = -1;
+        assert(h_enum == murmur3_hash(int(minus_one), Topic::users, 'x', true, 1L << 40));
+#if __cpp_lib_bit_cast >= 201806L
+        constexpr uint32_t h_float = murmur3_hash(12.5f, -0.25);
+        volatile float f = 12.5f;
+        assert((h_float == murmur3<float, double>().apply(float(f), -0.25)));
+#endif
+        assert(route("orders", 1) == 2 && route("users", 0) == 3 && route("users", 1) == 0);
+
+        // Perfect hash table of keywords, the seed is found by the compiler.
+        constexpr std::string_view words[] = {"get", "put", "delete", "head", "post", "patch", "options"};
+        constexpr uint32_t seed = murmur3_perfect_seed(words, 8);
+        static_assert(seed != UINT32_MAX, "");
+        bool used[8] = {};
+        for (auto w : words) {
+            std::size_t slot = murmur3_32(w.data(), w.size(), seed) % 8;
+            assert(!used[slot]);
+            used[slot] = true;
+        }
+    }
+
+    // Test that a key fed in pieces hashes the same as all at once, for every way to cut it in three.
+    {
+        std::vector<uint8_t> key(40);
+        for (auto &b : key) {
+            b = uint8_t(rand());
+        }
+        for (std::size_t len = 0; len <= key.size(); len++) {
+            uint32_t h = murmur3_32(key.data(), len, 42);
+            murmur3_128_t h128 = murmur3_x64_128(key.data(), len, 42);
+            for (std::size_t i = 0; i <= len; i++) {
+                for (std::size_t j = i; j <= len; j++) {
+                    assert(hash_pieces<murmur3_32_stream>(key, len, i, j) == h);
+                    assert(hash_pieces<murmur3_x64_128_stream>(key, len, i, j) == h128);
+                }
+            }
+        }
+        // Keys that don't start on an aligned address hash the same.
+        std::vector<uint8_t> shifted(key.size() + 8);
+        for (std::size_t offset = 0; offset < 8; offset++) {
+            std::copy(key.begin(), key.end(), shifted.begin() + offset);
+            assert(murmur3_32(shifted.data() + offset, key.size()) == murmur3_32(key.data(), key.size()));
+            assert(murmur3_x64_128(shifted.data() + offset, key.size()) == murmur3_x64_128(key.data(), key.size()));
+        }
+        // Numbers taken from a register hash the same as their bytes, whatever is carried over.
+        for (std::size_t carried = 0; carried < 4; carried++) {
+            for (std::size_t n : {1, 2, 4, 8}) {
+                uint64_t u = 0;
+                for (std::size_t k = 0; k < n; k++) {
+                    u |= uint64_t(key[carried + k]) << 8*k;
+                }
+                murmur3_32_stream from_bytes(3), from_register(3);
+                from_bytes.update(key.data(), carried + n);
+                from_register.update(key.data(), carried);
+                from_register.update_le(u, n);
+                assert(from_register.finalize() == from_bytes.finalize());
+            }
+        }
+        // init() starts over.
+        murmur3_32_stream s(1);
+        s.update(key.data(), 7);
+        s.init(42);
+        s.update(key.data(), 5);
+        assert(s.finalize() == murmur3_32(key.data(), 5, 42));
+    }
+
+    // Test that batches hash the same as one key at a time, for all lengths and any number of keys.
+    {
+        std::vector<uint8_t> keys(40*21 + 1);
+        for (auto &b : keys) {
+            b = uint8_t(rand());
+        }
+        for (std::size_t len = 0; len <= 40; len++) {
+            for (std::size_t n = 0; n <= 21; n++) {
+                std::vector<uint32_t> out(n + 1, 0xdeadbeef);
+                murmur3_32_batch(keys.data() + 1, len, n, out.data(), 7);
+                for (std::size_t i = 0; i < n; i++) {
+                    assert(out[i] == murmur3_32(keys.data() + 1 + i*len, len, 7));
+                }
+                assert(out[n] == 0xdeadbeef);
+            }
+        }
+        std::vector<const uint8_t *> ptrs;
+        std::vector<std::size_t> lens;
+        for (int i = 0; i < 23; i++) {
+            ptrs.push_back(keys.data() + rand()%100);
+            lens.push_back(i%5 == 0 ? 0 : rand()%600);
+        }
+        std::vector<uint32_t> out(ptrs.size());
+        murmur3_32_batch(ptrs.data(), lens.data(), ptrs.size(), out.data(), 7);
+        for (std::size_t i = 0; i < ptrs.size(); i++) {
+            assert(out[i] == murmur3_32(ptrs[i], lens[i], 7));
+        }
+    }
+
+    // Test batches of composite keys, of numbers only and with strings.
+    {
+        std::vector<std::tuple<char, int, float, double>> nums;
+        std::vector<std::tuple<int, std::string, double>> strs;
+        for (int i = 0; i < 150; i++) {
+            nums.emplace_back('a' + i%26, i*7, i*0.5f, i/3.0);
+            strs.emplace_back(i, std::string(i%17, 'x'), i*0.25);
+        }
+        murmur3<char, int, float, double> m_nums;
+        murmur3<int, std::string, double> m_strs;
+        murmur3_128<int, std::string, double> m_128;
+        std::vector<uint32_t> out(nums.size());
+        m_nums.apply_batch(nums.data(), nums.size(), out.data());
+        for (std::size_t i = 0; i < nums.size(); i++) {
+            assert(out[i] == std::apply([&](auto... v) { return m_nums.apply(v...); }, nums[i]));
+        }
+        m_strs.apply_batch(strs.data(), strs.size() - 1, out.data());
+        std::vector<murmur3_128_t> out_128(strs.size());
+        m_128.apply_batch(strs.data(), strs.size(), out_128.data());
+        for (std::size_t i = 0; i < strs.size() - 1; i++) {
+            assert(out[i] == std::apply([&](const auto &... v) { return m_strs.apply(v...); }, strs[i]));
+            assert(out_128[i] == std::apply([&](const auto &... v) { return m_128.apply(v...); }, strs[i]));
+        }
+    }
+
+    // Test that composite keys hash the bytes above, from arguments and from a tuple.
+    {
+        char chars[] = "Hello";
+        std::string str = "Hello World";
+        murmur3<char, int, float, double, char *, std::string> m;
+        std::vector<uint8_t> bytes;
+        append_bytes(bytes, 'a');
+        append_bytes(bytes, 12);
+        append_bytes(bytes, 12.5f);
+        append_bytes(bytes, 12.5);
+        append_bytes(bytes, std::string(chars));
+        append_bytes(bytes, str);
+        uint32_t h = murmur3_32(bytes.data(), bytes.size());
+        assert(h == 2531343990);
+        assert(m.apply('a', 12, 12.5f, 12.5, chars, str) == h);
+        assert(m.apply([&]() { return std::make_tuple('a', 12, 12.5f, 12.5, chars, str); }) == h);
+
+        murmur3_128<char, int, float, double, char *, std::string> m128;
+        assert(m128.apply('a', 12, 12.5f, 12.5, chars, str) == murmur3_x64_128(bytes.data(), bytes.size()));
+
+        murmur3<> none;
+        assert(none.apply() == 0);
+        murmur3<int> one;
+        assert(one.apply(7) != one.apply(8));
+
+        // Seeded, the same bytes go to murmur3_32 and murmur3_x64_128 under the seed.
+        constexpr uint32_t seed = 0x9747b28c;
+        static_assert(murmur3<uint32_t>(seed).apply(0) == murmur3_32("\0\0\0\0", 4, seed), "");
+        murmur3<char, int, float, double, char *, std::string> seeded(seed);
+        assert(seeded.seed() == seed && m.seed() == 0);
+        assert(seeded.apply('a', 12, 12.5f, 12.5, chars, str) == murmur3_32(bytes.data(), bytes.size(), seed));
+        assert(seeded.apply([&]() { return std::make_tuple('a', 12, 12.5f, 12.5, chars, str); })
+            == murmur3_32(bytes.data(), bytes.size(), seed));
+        assert((murmur3_128<char, int, float, double, char *, std::string>(seed).apply('a', 12, 12.5f, 12.5, chars, str)
+            == murmur3_x64_128(bytes.data(), bytes.size(), seed)));
+    }
+
+    // Test seeded batches and the random seeds.
+    {
+        std::vector<std::tuple<int, double>> nums;
+        std::vector<std::tuple<std::string, int>> strs;
+        for (int i = 0; i < 100; i++) {
+            nums.emplace_back(i, i*0.5);
+            strs.emplace_back(std::to_string(i), i);
+        }
+        const murmur3<int, double> m_nums(42);
+        const murmur3<std::string, int> m_strs(42);
+        std::vector<uint32_t> out(nums.size()), out_strs(strs.size());
+        m_nums.apply_batch(nums.data(), nums.size(), out.data());
+        m_strs.apply_batch(strs.data(), strs.size(), out_strs.data());
+        for (int i = 0; i < 100; i++) {
+            assert(out[i] == m_nums.apply(i, i*0.5) && out[i] != murmur3_hash(i, i*0.5));
+            assert(out_strs[i] == m_strs.apply(std::to_string(i), i));
+        }
+
+        assert(murmur3_process_seed() == murmur3_process_seed());
+        uint32_t a = murmur3_random_seed(), b = murmur3_random_seed();
+        assert(a != b && murmur3<int>(a).apply(1) != murmur3<int>(b).apply(1));
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef SHARDROUTER_HPP
+#define SHARDROUTER_HPP
+
+#include <stdint.h>
+#include <stdexcept>
+#include <utility>
+#include "Map.hpp"
+#include "Murmur3.hpp"
+
+namespace cs540 {
+
+/*
+ * Jump consistent hash (Lamping and Veach): shard in [0, shards) of key. Going from n to n + 1
+ * shards only moves the keys that land in the new shard, 1/(n + 1) of them, and no table is kept.
+ * Shards can only be added and removed at the end.
+ */
+inline int32_t jumpHash(uint64_t key, int32_t shards) {
+	int64_t b = -1, j = 0;
+	while(j < shards) {
+		b = j;
+		key = key*2862933555777941757ULL + 1;
+		j = int64_t((b + 1)*(double(int64_t(1) << 31)/double((key >> 33) + 1)));
+	}
+	return int32_t(b);
+}
+
+/* -------------------------- JumpRouter Class -------------------------- */
+// Routes keys made of Args... to shards 0 to size() - 1 by jumpHash() of their murmur3 hash
+template <class... Args>
+class JumpRouter {
+	int32_t shards;
+	public:
+		explicit JumpRouter(int32_t n) : shards(n) { }
+		int32_t size() const { return shards; }
+		// Keys only move to the added shards, or away from the removed ones
+		void resize(int32_t n) { shards = n; }
+		int32_t route(const Args &... key) const { return jumpHash(murmur3<Args...>().apply(key...), shards); }
+};
+
+/* -------------------------- RingRouter Class -------------------------- */
+/*
+ * Consistent hashing on a ring of 32 bit murmur3 hashes. Every node is put at replicas points on
+ * the ring, the hashes of (node, 0) to (node, replicas - 1), and a key goes to the node of the
+ * first point at or after its hash, wrapping around. Adding a node only takes keys from the
+ * points in front of its own, removing one only gives its keys to the points after them. More
+ * points per node spread the keys more evenly. Node_T is hashed with murmur3 and compared with ==.
+ */
+template <class Node_T, class... Args>
+class RingRouter {
+	Map<uint32_t, Node_T> ring; // Point on the ring to its node
+	int replicas;
+	static uint32_t point(const Node_T & node, int i) { return murmur3<Node_T, int>().apply(node, i); }
+	public:
+		explicit RingRouter(int r = 160) : replicas(r) { }
+		int points() const { return ring.size(); }
+		bool empty() const { return ring.empty(); }
+		// Points that another node already has stay with it
+		void add(const Node_T & node) {
+			for(int i = 0; i < replicas; i++) {
+				ring.insert(std::make_pair(point(node, i), node));
+			}
+		}
+		void remove(const Node_T & node) {
+			for(int i = 0; i < replicas; i++) {
+				auto it = ring.find(point(node, i));
+				if(it != ring.end() && (*it).second == node) ring.erase(it);
+			}
+		}
+		const Node_T & route(const Args &... key) const {
+			auto it = ring.lower_bound(murmur3<Args...>().apply(key...));
+			if(it == ring.end()) it = ring.begin();
+			if(it == ring.end()) throw std::out_of_range("No nodes!");
+			return (*it).second;
+		}
+};
+}
+#endif
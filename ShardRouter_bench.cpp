@@ -0,0 +1,109 @@
+/*
+ * Routing of keys to nodes by murmur3 modulo the number of nodes, jump hash and rings with a few
+ * numbers of points a node. Run with
+ *
+ *    -n keys
+ *    -s nodes
+ *
+ * to set the number of keys routed (defaults to 1000000) and the number of nodes (defaults to 10).
+ * For each router it prints the lookups per second, how far the busiest and the idlest node are
+ * from an even share of the keys, and how many keys move when a node is added.
+ */
+
+// NOTE compile with -O2
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "ShardRouter.hpp"
+
+/*
+ * Route keys 0 to n - 1 with route(k) and print the results. route(k) returns a node number, grow()
+ * adds a node.
+ */
+
+template <typename R, typename G>
+void
+bench_router(const char *name, int n, int n_nodes, R route, G grow) {
+
+    std::vector<int> nodes(n);
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < n; k++) {
+        nodes[k] = route(k);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<long> counts(n_nodes);
+    for (int node : nodes) {
+        counts[node]++;
+    }
+    double mean = double(n)/n_nodes, var = 0;
+    for (long c : counts) {
+        var += (c - mean)*(c - mean)/n_nodes;
+    }
+    auto minmax = std::minmax_element(counts.begin(), counts.end());
+
+    grow();
+    long moved = 0;
+    for (int k = 0; k < n; k++) {
+        moved += route(k) != nodes[k];
+    }
+
+    printf("%-24s %8.1f ns/lookup  %8.2f Mlookups/s  min %+6.1f%%  max %+6.1f%%  stddev %5.1f%%  moved %5.1f%%\n",
+        name, secs*1e9/n, n/secs/1e6, (*minmax.first/mean - 1)*100, (*minmax.second/mean - 1)*100,
+        sqrt(var)/mean*100, moved*100.0/n);
+}
+
+int
+main(int argc, char *argv[]) {
+
+    int n = 1000000;
+    int n_nodes = 10;
+
+    {
+        int c;
+        while ((c = getopt(argc, argv, "n:s:")) != EOF) {
+            switch (c) {
+                case 'n':
+                    n = atoi(optarg);
+                    break;
+                case 's':
+                    n_nodes = atoi(optarg);
+                    break;
+                case '?':
+                    fprintf(stderr, "Unrecog.\n");
+                    exit(1);
+            }
+        }
+    }
+
+    printf("---- %d keys (string, int) on %d nodes, then %d\n", n, n_nodes, n_nodes + 1);
+    const std::string user = "user";
+    {
+        int mod = n_nodes;
+        bench_router("murmur3 % nodes", n, n_nodes, [&](int k) {
+            return int(murmur3<std::string, int>().apply(user, k) % mod);
+        }, [&]() { mod++; });
+    }
+    {
+        cs540::JumpRouter<std::string, int> router(n_nodes);
+        bench_router("JumpRouter", n, n_nodes, [&](int k) {
+            return int(router.route(user, k));
+        }, [&]() { router.resize(n_nodes + 1); });
+    }
+    for (int replicas : {1, 16, 160, 1000}) {
+        cs540::RingRouter<int, std::string, int> ring(replicas);
+        for (int i = 0; i < n_nodes; i++) {
+            ring.add(i);
+        }
+        char name[64];
+        snprintf(name, sizeof name, "RingRouter, %d points", replicas);
+        bench_router(name, n, n_nodes, [&](int k) {
+            return ring.route(user, k);
+        }, [&]() { ring.add(n_nodes); });
+    }
+}
@@ -0,0 +1,92 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "ShardRouter.hpp"
+
+int
+main() {
+
+    // Test that jump hash spreads keys evenly and only moves them to an added shard.
+    {
+        assert(cs540::jumpHash(0, 1) == 0 && cs540::jumpHash(~uint64_t(0), 1) == 0);
+        std::vector<int> counts(10);
+        for (uint32_t k = 0; k < 100000; k++) {
+            uint64_t key = murmur3_hash(k);
+            int32_t shard = cs540::jumpHash(key, 10);
+            assert(shard >= 0 && shard < 10);
+            counts[shard]++;
+            for (int32_t n = 1; n < 40; n++) {
+                int32_t before = cs540::jumpHash(key, n), after = cs540::jumpHash(key, n + 1);
+                assert(after == before || after == n);
+            }
+        }
+        for (int c : counts) {
+            assert(c > 9000 && c < 11000);
+        }
+
+        cs540::JumpRouter<std::string, int> router(10);
+        assert(router.route("orders", 3) == cs540::jumpHash(murmur3_hash("orders", 3), 10));
+        router.resize(11);
+        assert(router.size() == 11 && router.route("orders", 3) == cs540::jumpHash(murmur3_hash("orders", 3), 11));
+    }
+
+    // Test that a ring only moves the keys of the node that is added or removed.
+    {
+        cs540::RingRouter<std::string, std::string, int> ring;
+        assert(ring.empty());
+        try {
+            ring.route("orders", 1);
+            assert(false);
+        } catch (std::out_of_range &) {
+        }
+
+        std::vector<std::string> nodes;
+        for (int i = 0; i < 10; i++) {
+            nodes.push_back("worker-" + std::to_string(i));
+            ring.add(nodes.back());
+        }
+        ring.add(nodes[3]);
+        assert(ring.points() == 10*160);
+
+        const int n_keys = 20000;
+        std::vector<std::string> before;
+        std::vector<int> counts(10);
+        for (int k = 0; k < n_keys; k++) {
+            before.push_back(ring.route("user", k));
+            counts[before.back()[7] - '0']++;
+        }
+        // 160 points a node keep every node within half of its share.
+        for (int c : counts) {
+            assert(c > n_keys/10/2 && c < n_keys/10*3/2);
+        }
+
+        ring.add("worker-10");
+        int moved = 0;
+        for (int k = 0; k < n_keys; k++) {
+            const std::string &node = ring.route("user", k);
+            if (node != before[k]) {
+                assert(node == "worker-10");
+                moved++;
+            }
+        }
+        assert(moved > n_keys/11/2 && moved < n_keys/11*3/2);
+
+        ring.remove("worker-10");
+        ring.remove("worker-10");
+        for (int k = 0; k < n_keys; k++) {
+            assert(ring.route("user", k) == before[k]);
+        }
+
+        ring.remove(nodes[3]);
+        assert(ring.points() == 9*160);
+        for (int k = 0; k < n_keys; k++) {
+            const std::string &node = ring.route("user", k);
+            assert(node != nodes[3] && (node == before[k] || before[k] == nodes[3]));
+        }
+
+        cs540::RingRouter<int, uint64_t> one(1);
+        one.add(7);
+        assert(one.points() == 1 && one.route(0) == 7 && one.route(~uint64_t(0)) == 7);
+    }
+}
@@ -0,0 +1,161 @@
+#ifndef SKETCH_HPP
+#define SKETCH_HPP
+
+#include <stdint.h>
+#include <math.h>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include "Murmur3.hpp"
+
+namespace cs540 {
+
+/*
+ * The k hash functions of a key come from the two halves of its murmur3_x64_128 hash by double
+ * hashing (Kirsch and Mitzenmacher): the i-th is h1 + i*h2, which gives the same false positive
+ * rate as k independent hashes.
+ */
+inline uint32_t nthHash(const murmur3_128_t & h, uint32_t i) { return uint32_t(h.h1) + i*uint32_t(h.h2); }
+
+// Maps a 32 bit hash to [0, n) without a division
+inline uint32_t reduceHash(uint32_t hash, uint32_t n) { return uint32_t((uint64_t(hash)*n) >> 32); }
+
+// Plain words, or atomic ones that several threads can set bits or add counts in at once
+template <class T, bool Concurrent>
+using SketchWord = std::conditional_t<Concurrent, std::atomic<T>, T>;
+
+/* -------------------------- BloomFilter Class -------------------------- */
+/*
+ * Blocked Bloom filter of keys made of Args...: the k bits of a key are all in one 512 bit block,
+ * a cache line, picked by the high half of h1, so an insert or a lookup touches a single line.
+ * contains() is never wrong for keys that were inserted, and true for others at about the false
+ * positive rate it was sized for, a little more since blocks don't fill up evenly. With
+ * Concurrent = true, insert() and contains() can be called from any number of threads at once,
+ * bits are set with atomic fetch_or.
+ */
+template <bool Concurrent, class... Args>
+class BasicBloomFilter {
+	struct alignas(64) Block {
+		SketchWord<uint64_t, Concurrent> words[8];
+	};
+	std::unique_ptr<Block[]> blocks;
+	uint32_t nBlocks;
+	uint32_t k;
+	Block & blockOf(const murmur3_128_t & h) const { return blocks[reduceHash(uint32_t(h.h1 >> 32), nBlocks)]; }
+	// The k bits of h in a block as the masks of its 8 words
+	void masks(const murmur3_128_t & h, uint64_t (&mask)[8]) const {
+		for(int w = 0; w < 8; w++) mask[w] = 0;
+		for(uint32_t i = 0; i < k; i++) {
+			uint32_t bit = nthHash(h, i) >> 23;
+			mask[bit >> 6] |= uint64_t(1) << (bit & 63);
+		}
+	}
+	public:
+		// Sized for n keys at a false positive rate of p: n*log2(1/p)/ln(2) bits and log2(1/p) hashes
+		BasicBloomFilter(std::size_t n, double p)
+			: nBlocks(uint32_t((std::size_t(-double(n)*log(p)/(M_LN2*M_LN2)) + 512)/512)), k(uint32_t(lround(-log(p)/M_LN2))) {
+			if(k < 1) k = 1;
+			if(k > 16) k = 16;
+			blocks.reset(new Block[nBlocks]);
+			clear();
+		}
+		std::size_t bits() const { return std::size_t(nBlocks)*512; }
+		uint32_t hashes() const { return k; }
+		void clear() {
+			for(uint32_t b = 0; b < nBlocks; b++) {
+				for(auto & word : blocks[b].words) word = 0;
+			}
+		}
+		void insert(const Args &... key) {
+			murmur3_128_t h = murmur3_128<Args...>().apply(key...);
+			uint64_t mask[8];
+			masks(h, mask);
+			Block & block = blockOf(h);
+			for(int w = 0; w < 8; w++) {
+				if constexpr (Concurrent) {
+					if(mask[w] != 0) block.words[w].fetch_or(mask[w], std::memory_order_relaxed);
+				} else {
+					block.words[w] |= mask[w];
+				}
+			}
+		}
+		bool contains(const Args &... key) const {
+			murmur3_128_t h = murmur3_128<Args...>().apply(key...);
+			uint64_t mask[8];
+			masks(h, mask);
+			const Block & block = blockOf(h);
+			uint64_t missing = 0;
+			for(int w = 0; w < 8; w++) {
+				uint64_t word;
+				if constexpr (Concurrent) {
+					word = block.words[w].load(std::memory_order_relaxed);
+				} else {
+					word = block.words[w];
+				}
+				missing |= mask[w] & ~word;
+			}
+			return missing == 0;
+		}
+};
+
+template <class... Args>
+using BloomFilter = BasicBloomFilter<false, Args...>;
+
+template <class... Args>
+using ConcurrentBloomFilter = BasicBloomFilter<true, Args...>;
+
+/* -------------------------- CountMinSketch Class -------------------------- */
+/*
+ * Count-min sketch of keys made of Args...: depth rows of width counters, a key counts in one
+ * counter of every row, picked by the row-th double hash, and its estimate is the smallest of
+ * them. Estimates are never below the true count and, with probability 1 - delta, at most
+ * epsilon times the total count above it. Rows stay separate rather than blocked in one cache
+ * line, so that their collisions are independent, which the bound needs. With Concurrent = true
+ * add() and estimate() can be called from any number of threads at once.
+ */
+template <bool Concurrent, class... Args>
+class BasicCountMinSketch {
+	std::unique_ptr<SketchWord<uint32_t, Concurrent>[]> counters;
+	uint32_t width;
+	uint32_t depth;
+	public:
+		// e/epsilon counters in each of ln(1/delta) rows
+		BasicCountMinSketch(double epsilon, double delta) : width(uint32_t(ceil(M_E/epsilon))), depth(uint32_t(ceil(log(1/delta)))) {
+			if(depth < 1) depth = 1;
+			counters.reset(new SketchWord<uint32_t, Concurrent>[std::size_t(width)*depth]);
+			clear();
+		}
+		uint32_t rows() const { return depth; }
+		uint32_t columns() const { return width; }
+		void clear() {
+			for(std::size_t i = 0; i < std::size_t(width)*depth; i++) counters[i] = 0;
+		}
+		void add(const Args &... key) {
+			murmur3_128_t h = murmur3_128<Args...>().apply(key...);
+			for(uint32_t row = 0; row < depth; row++) {
+				auto & counter = counters[std::size_t(row)*width + reduceHash(nthHash(h, row), width)];
+				if constexpr (Concurrent) {
+					counter.fetch_add(1, std::memory_order_relaxed);
+				} else {
+					counter++;
+				}
+			}
+		}
+		uint32_t estimate(const Args &... key) const {
+			murmur3_128_t h = murmur3_128<Args...>().apply(key...);
+			uint32_t count = UINT32_MAX;
+			for(uint32_t row = 0; row < depth; row++) {
+				uint32_t c = counters[std::size_t(row)*width + reduceHash(nthHash(h, row), width)];
+				if(c < count) count = c;
+			}
+			return count;
+		}
+};
+
+template <class... Args>
+using CountMinSketch = BasicCountMinSketch<false, Args...>;
+
+template <class... Args>
+using ConcurrentCountMinSketch = BasicCountMinSketch<true, Args...>;
+}
+#endif
@@ -0,0 +1,193 @@
+/*
+ * Inserts and lookups in cs540::BloomFilter and cs540::CountMinSketch, with the false positive
+ * rate and the count errors measured. Run with
+ *
+ *    -n keys
+ *    -t threads
+ *
+ * to set the number of keys inserted (defaults to 1000000) and the number of threads inserting into
+ * the concurrent variants at once (defaults to 4).
+ */
+
+// NOTE compile with -O2 -pthread
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Map.hpp"
+#include "Sketch.hpp"
+
+static std::chrono::steady_clock::time_point start;
+
+void
+begin_timer() {
+    start = std::chrono::steady_clock::now();
+}
+
+double
+report(const char *name, long ops) {
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-44s %8.1f ns/op  %8.2f Mops/s\n", name, secs*1e9/ops, ops/secs/1e6);
+    return secs;
+}
+
+// Call f(i) for i in [0, n) split over n_threads threads
+template <typename F>
+void
+run_threads(int n_threads, int n, F f) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; t++) {
+        threads.emplace_back([=]() {
+            for (int i = t; i < n; i += n_threads) {
+                f(i);
+            }
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/*
+ * Keys ("user", 0) to ("user", n - 1) go in, ("user", n) to ("user", 2n - 1) are the misses.
+ */
+
+template <typename FILTER_T>
+void
+bench_filter(const char *name, int n, double p) {
+
+    char label[64];
+    FILTER_T filter(n, p);
+    const std::string user = "user";
+
+    begin_timer();
+    for (int i = 0; i < n; i++) {
+        filter.insert(user, i);
+    }
+    snprintf(label, sizeof label, "%s insert()", name);
+    report(label, n);
+
+    long found = 0;
+    begin_timer();
+    for (int i = 0; i < n; i++) {
+        found += filter.contains(user, i);
+    }
+    snprintf(label, sizeof label, "%s contains() hit", name);
+    report(label, n);
+
+    long positives = 0;
+    begin_timer();
+    for (int i = n; i < 2*n; i++) {
+        positives += filter.contains(user, i);
+    }
+    snprintf(label, sizeof label, "%s contains() miss", name);
+    report(label, n);
+    printf("    %.1f bits/key, %u hashes, false positives %.4f%% for %.4f%%, %ld of %d found\n",
+        double(filter.bits())/n, filter.hashes(), positives*100.0/n, p*100, found, n);
+}
+
+int
+main(int argc, char *argv[]) {
+
+    int n = 1000000;
+    int n_threads = 4;
+
+    {
+        int c;
+        while ((c = getopt(argc, argv, "n:t:")) != EOF) {
+            switch (c) {
+                case 'n':
+                    n = atoi(optarg);
+                    break;
+                case 't':
+                    n_threads = atoi(optarg);
+                    break;
+                case '?':
+                    fprintf(stderr, "Unrecog.\n");
+                    exit(1);
+            }
+        }
+    }
+
+    printf("---- Bloom filters of %d (string, int) keys\n", n);
+    for (double p : {0.01, 0.001}) {
+        bench_filter<cs540::BloomFilter<std::string, int>>("BloomFilter", n, p);
+        bench_filter<cs540::ConcurrentBloomFilter<std::string, int>>("ConcurrentBloomFilter", n, p);
+    }
+    {
+        cs540::ConcurrentBloomFilter<int> filter(n, 0.01);
+        begin_timer();
+        run_threads(n_threads, n, [&](int i) { filter.insert(i); });
+        char label[64];
+        snprintf(label, sizeof label, "ConcurrentBloomFilter insert(), %d threads", n_threads);
+        report(label, n);
+    }
+
+    // Misses of a cold tier, with and without a filter in front of it.
+    {
+        int m = n < 200000 ? n : 200000;
+        printf("---- Misses in a Map of %d int keys\n", m);
+        cs540::Map<const int, int> map;
+        cs540::BloomFilter<int> filter(m, 0.01);
+        for (int i = 0; i < m; i++) {
+            map.insert(std::make_pair(2*i, i));
+            filter.insert(2*i);
+        }
+        long found = 0;
+        begin_timer();
+        for (int i = 0; i < m; i++) {
+            found += map.find(2*i + 1) != map.end();
+        }
+        report("Map::find()", m);
+        begin_timer();
+        for (int i = 0; i < m; i++) {
+            found += filter.contains(2*i + 1) && map.find(2*i + 1) != map.end();
+        }
+        report("BloomFilter::contains(), then Map::find()", m);
+        if (found != 0) {
+            printf("    found %ld\n", found);
+        }
+    }
+
+    printf("---- Count-min sketches of %d skewed int keys\n", n);
+    for (double epsilon : {0.001, 0.0001}) {
+        const double delta = 0.01;
+        std::vector<int> keys(n);
+        std::unordered_map<int, uint32_t> counts;
+        for (int i = 0; i < n; i++) {
+            keys[i] = rand() % (1 + rand() % 100000);
+            counts[keys[i]]++;
+        }
+        cs540::CountMinSketch<int> sketch(epsilon, delta);
+        char label[64];
+        begin_timer();
+        for (int k : keys) {
+            sketch.add(k);
+        }
+        snprintf(label, sizeof label, "CountMinSketch add(), epsilon %g", epsilon);
+        report(label, n);
+
+        double error = 0;
+        long over = 0;
+        begin_timer();
+        for (auto &c : counts) {
+            uint32_t estimate = sketch.estimate(c.first);
+            error += estimate - c.second;
+            over += estimate - c.second > epsilon*n;
+        }
+        snprintf(label, sizeof label, "CountMinSketch estimate(), epsilon %g", epsilon);
+        report(label, counts.size());
+        printf("    %u x %u counters, mean error %.2f (epsilon*N %.0f), %.3f%% above epsilon*N for %.1f%%\n",
+            sketch.rows(), sketch.columns(), error/counts.size(), epsilon*n, over*100.0/counts.size(), delta*100);
+
+        cs540::ConcurrentCountMinSketch<int> shared(epsilon, delta);
+        begin_timer();
+        run_threads(n_threads, n, [&](int i) { shared.add(keys[i]); });
+        snprintf(label, sizeof label, "ConcurrentCountMinSketch add(), %d threads", n_threads);
+        report(label, n);
+    }
+}
@@ -0,0 +1,86 @@
+// NOTE compile with -pthread
+#include <assert.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Sketch.hpp"
+
+int
+main() {
+
+    // Test that a Bloom filter has no false negatives and about the false positive rate it is sized for.
+    {
+        const int n = 100000;
+        cs540::BloomFilter<std::string, int> filter(n, 0.01);
+        assert(filter.hashes() == 7 && filter.bits() >= std::size_t(n*9.58) && filter.bits() % 512 == 0);
+        assert(!filter.contains("user", 1));
+        for (int i = 0; i < n; i++) {
+            filter.insert("user", i);
+        }
+        int positives = 0;
+        for (int i = 0; i < n; i++) {
+            assert(filter.contains("user", i));
+            positives += filter.contains("user", n + i) + filter.contains("item", i);
+        }
+        assert(positives < 2*n*0.01*2);
+        filter.clear();
+        assert(!filter.contains("user", 1));
+
+        cs540::BloomFilter<int> tiny(1, 0.5);
+        assert(tiny.hashes() == 1 && tiny.bits() == 512);
+        tiny.insert(1);
+        assert(tiny.contains(1));
+    }
+
+    // Test inserts from several threads at once.
+    {
+        const int n = 200000, n_threads = 4;
+        cs540::ConcurrentBloomFilter<int> filter(n, 0.001);
+        cs540::ConcurrentCountMinSketch<int> sketch(0.001, 0.01);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < n_threads; t++) {
+            threads.emplace_back([&, t]() {
+                for (int i = t; i < n; i += n_threads) {
+                    filter.insert(i);
+                    sketch.add(i % 1000);
+                }
+            });
+        }
+        for (auto &th : threads) {
+            th.join();
+        }
+        for (int i = 0; i < n; i++) {
+            assert(filter.contains(i));
+        }
+        for (int i = 0; i < 1000; i++) {
+            assert(sketch.estimate(i) >= 200);
+        }
+    }
+
+    // Test that count-min estimates are never low and rarely more than epsilon times the total high.
+    {
+        const double epsilon = 0.001, delta = 0.01;
+        cs540::CountMinSketch<std::string, int> sketch(epsilon, delta);
+        assert(sketch.columns() == 2719 && sketch.rows() == 5);
+        std::unordered_map<int, uint32_t> counts;
+        const int total = 500000;
+        for (int i = 0; i < total; i++) {
+            // Skewed: small keys come up far more often.
+            int k = rand() % (1 + rand() % 10000);
+            sketch.add("topic", k);
+            counts[k]++;
+        }
+        int over = 0;
+        for (auto &c : counts) {
+            uint32_t estimate = sketch.estimate("topic", c.first);
+            assert(estimate >= c.second);
+            over += estimate - c.second > epsilon*total;
+        }
+        assert(over <= counts.size()*delta*2);
+        assert(sketch.estimate("topic", -1) <= epsilon*total*2);
+        sketch.clear();
+        assert(sketch.estimate("topic", 0) == 0);
+    }
+}